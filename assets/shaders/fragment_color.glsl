@@ -2,9 +2,8 @@
 
 precision highp float;
 out vec4 fragColor;
-
-uniform vec4 color;
+in vec4 vertexColor;
 
 void main() {
-    fragColor = color;
+    fragColor = vertexColor;
 }
@@ -3,10 +3,11 @@
 precision highp float;
 out vec4 fragColor;
 in vec2 texCoord;
+in vec4 vertexColor;
 
 uniform sampler2D utexture;
 
 void main() {
     vec4 tex = texture(utexture, texCoord);
-    fragColor = tex;
+    fragColor = tex * vertexColor;
 }
@@ -1,12 +1,17 @@
 #version 410 core
 
-layout (location = 0) in vec3 in_Position;
+layout (location = 0) in vec4 in_Position;
 layout (location = 1) in vec2 in_TexCoord;
+layout (location = 2) in mat4 in_MVP;
+layout (location = 6) in vec4 in_TexRect;
+layout (location = 7) in vec4 in_Color;
 
-uniform mat4 MVP;
 out vec2 texCoord;
+out vec4 vertexColor;
 
 void main() {
-    gl_Position = MVP * vec4(in_Position, 1.0);
-    texCoord = in_TexCoord.xy;
+    // NOTE: MVP comes from the VM in row-major order
+    gl_Position = in_Position * in_MVP;
+    texCoord = in_TexRect.xy + in_TexCoord.xy * in_TexRect.zw;
+    vertexColor = in_Color;
 }
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "platform.hpp"
+#include <algorithm>
+
+// Every benchmark is measured this number of times, results are printed
+// as JSON lines to stdout.
+static const u32 BENCH_SAMPLES = 15;
+
+struct BenchContext {
+    const char* filter;
+    ShellConfig config;
+    Platform* platform;
+    Window* window;
+};
+
+static inline bool bench_enabled(BenchContext const& context, const char* name) {
+    return context.filter == nullptr || strstr(name, context.filter) != nullptr;
+}
+
+// Runs fn `iterations` times per sample, fn should return something depending
+// on the work to not let the compiler throw it away.
+template<typename F>
+void bench_run(BenchContext const& context, const char* name, u64 iterations, F fn) {
+    if (!bench_enabled(context, name)) {
+        return;
+    }
+
+    f64 samples[BENCH_SAMPLES];
+    u64 sink = 0;
+
+    // NOTE: Warm up caches and lazily created resources
+    for (u64 i = 0; i < iterations; i += 1) {
+        sink += fn();
+    }
+
+    for (u32 sample = 0; sample < BENCH_SAMPLES; sample += 1) {
+        const f64 start = platform_get_ticks();
+
+        for (u64 i = 0; i < iterations; i += 1) {
+            sink += fn();
+        }
+
+        samples[sample] = (platform_get_ticks() - start) * 1e6 / (f64) iterations;
+    }
+
+    std::sort(&samples[0], &samples[BENCH_SAMPLES]);
+    f64 mean = 0.0;
+
+    for (u32 sample = 0; sample < BENCH_SAMPLES; sample += 1) {
+        mean += samples[sample];
+    }
+
+    mean /= BENCH_SAMPLES;
+
+    printf(
+        "{\"benchmark\":\"%s\",\"iterations\":%llu,\"samples\":%u,"
+        "\"ns_per_op_min\":%.3f,\"ns_per_op_median\":%.3f,\"ns_per_op_mean\":%.3f,\"ns_per_op_max\":%.3f,\"sink\":%llu}\n",
+        name,
+        (unsigned long long) iterations,
+        BENCH_SAMPLES,
+        samples[0],
+        samples[BENCH_SAMPLES / 2],
+        mean,
+        samples[BENCH_SAMPLES - 1],
+        (unsigned long long) (sink & 0xff)
+    );
+
+    fflush(stdout);
+}
+
+// Writes commands in the layout of the VM commands buffer.
+struct CommandsBuilder {
+    u8* base;
+    u64 size;
+    u64 offset;
+    u64 count;
+    u64 command_offset;
+};
+
+static inline void commands_builder_write(CommandsBuilder* builder, void const* data, u64 size) {
+    assert(builder->offset + size <= builder->size);
+    memcpy(builder->base + builder->offset, data, size);
+    builder->offset += size;
+}
+
+static inline void commands_builder_write_i64(CommandsBuilder* builder, i64 value) {
+    commands_builder_write(builder, &value, sizeof(value));
+}
+
+static inline void commands_builder_write_i32(CommandsBuilder* builder, i32 value) {
+    commands_builder_write(builder, &value, sizeof(value));
+}
+
+static inline void commands_builder_write_f32(CommandsBuilder* builder, f32 value) {
+    commands_builder_write(builder, &value, sizeof(value));
+}
+
+static inline void commands_builder_write_string(CommandsBuilder* builder, const char* string) {
+    const u64 len = strlen(string);
+    commands_builder_write_i64(builder, len);
+    commands_builder_write(builder, string, len);
+}
+
+static inline void commands_builder_write_mat4f(CommandsBuilder* builder, f32 x, f32 y, f32 scale) {
+    const f32 values[16] = {
+        scale, 0.f, 0.f, x,
+        0.f, scale, 0.f, y,
+        0.f, 0.f, 1.f, 0.f,
+        0.f, 0.f, 0.f, 1.f,
+    };
+
+    commands_builder_write(builder, &values[0], sizeof(values));
+}
+
+static inline CommandsBuilder commands_builder_create(u8* base, u64 size, const char* address) {
+    CommandsBuilder builder = {
+        .base = base,
+        .size = size,
+        .offset = 0,
+        .count = 0,
+        .command_offset = 0,
+    };
+
+    // NOTE: Count is patched by commands_builder_finish
+    commands_builder_write_i64(&builder, 0);
+    commands_builder_write_string(&builder, address);
+
+    return builder;
+}
+
+static inline void commands_builder_begin(CommandsBuilder* builder, u64 command_id) {
+    commands_builder_write_i64(builder, command_id);
+    builder->command_offset = builder->offset;
+    commands_builder_write_i64(builder, 0);
+}
+
+static inline void commands_builder_end(CommandsBuilder* builder) {
+    const i64 skip = builder->offset - builder->command_offset - sizeof(i64);
+    memcpy(builder->base + builder->command_offset, &skip, sizeof(skip));
+    builder->count += 1;
+}
+
+static inline u64 commands_builder_finish(CommandsBuilder* builder) {
+    memcpy(builder->base, &builder->count, sizeof(builder->count));
+    return builder->offset;
+}
+
+void bench_memory(BenchContext const& context);
+
+void bench_commands(BenchContext const& context);
+
+void bench_assets(BenchContext const& context);
+
+void bench_render(BenchContext const& context);
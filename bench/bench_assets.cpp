@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "assets.hpp"
+#include "memory_tracking.hpp"
+
+#ifdef MEMORY_TRACKING
+static void bench_expect_tag_bytes(const char* category, u64 expected) {
+    const u64 live_bytes = memory_tracking_get_live_bytes(category);
+
+    if (live_bytes != expected) {
+        fprintf(stderr, "%s: %llu live bytes are tracked, expected %llu\n", category, (unsigned long long) live_bytes, (unsigned long long) expected);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// NOTE: Not timed, checks that assets are charged to their tags and released with the region
+static void bench_check_asset_tags(BenchContext const& context, GrowableRegionMemoryBuffer* region) {
+    if (!bench_enabled(context, "assets/memory_tags")) {
+        return;
+    }
+
+    growable_region_memory_buffer_free(region);
+
+    const u64 shader_bytes = memory_tracking_get_live_bytes("assets/shader");
+    const u64 texture_bytes = memory_tracking_get_live_bytes("assets/texture");
+    const u64 font_bytes = memory_tracking_get_live_bytes("assets/font");
+
+    const auto shader = result_unwrap(asset_load_data(context.config, region, AssetType::shader, "vertex_transform.glsl"));
+    const auto texture = result_unwrap(asset_load_data(context.config, region, AssetType::texture, "test.jpg"));
+    const auto font = result_unwrap(asset_load_data(context.config, region, AssetType::font, "DejaVuSans.ttf"));
+
+    // NOTE: Shader source is terminated by \0
+    bench_expect_tag_bytes("assets/shader", shader_bytes + shader.size + 1);
+    bench_expect_tag_bytes("assets/texture", texture_bytes + texture.size);
+    bench_expect_tag_bytes("assets/font", font_bytes + font.size);
+
+    growable_region_memory_buffer_free(region);
+
+    bench_expect_tag_bytes("assets/shader", shader_bytes);
+    bench_expect_tag_bytes("assets/texture", texture_bytes);
+    bench_expect_tag_bytes("assets/font", font_bytes);
+}
+#endif
+
+void bench_assets(BenchContext const& context) {
+    auto region_result = create_growable_region_memory_buffer(megabytes(1), megabytes(32));
+    GrowableRegionMemoryBuffer region = result_unwrap(region_result);
+
+#ifdef MEMORY_TRACKING
+    bench_check_asset_tags(context, &region);
+#endif
+
+    bench_run(context, "assets/load_jpeg_texture", 20, [&]() {
+        growable_region_memory_buffer_free(&region);
+        auto asset_result = asset_load_data(context.config, &region, AssetType::texture, "test.jpg");
+        return (u64) result_unwrap(asset_result).size;
+    });
+
+    bench_run(context, "assets/load_shader", 1000, [&]() {
+        growable_region_memory_buffer_free(&region);
+        auto asset_result = asset_load_data(context.config, &region, AssetType::shader, "vertex_transform.glsl");
+        return (u64) result_unwrap(asset_result).size;
+    });
+}
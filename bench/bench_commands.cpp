@@ -0,0 +1,58 @@
+#include "bench.hpp"
+#include "gapi/commands.hpp"
+
+static const u64 BENCH_MATRICES_COUNT = 4096;
+
+void bench_commands(BenchContext const& context) {
+    static u8 buffer[BENCH_MATRICES_COUNT * sizeof(f32) * 16];
+    CommandsBuilder builder = {
+        .base = &buffer[0],
+        .size = sizeof(buffer),
+    };
+
+    for (u64 i = 0; i < BENCH_MATRICES_COUNT; i += 1) {
+        commands_builder_write_mat4f(&builder, i, i * 2, 10.f);
+    }
+
+    bench_run(context, "commands/read_mat4f_4096", 100, [&]() {
+        auto reader = create_command_reader(&buffer[0], sizeof(buffer));
+        f32 sum = 0.f;
+
+        for (u64 i = 0; i < BENCH_MATRICES_COUNT; i += 1) {
+            const Mat4f matrix = read_mat4f(&reader);
+            f32 values[16];
+
+            memcpy(&values[0], &matrix, sizeof(values));
+            sum += values[3];
+        }
+
+        return (u64) sum;
+    });
+
+    bench_run(context, "commands/read_vec2f_32768", 100, [&]() {
+        auto reader = create_command_reader(&buffer[0], sizeof(buffer));
+        f32 sum = 0.f;
+
+        for (u64 i = 0; i < BENCH_MATRICES_COUNT * 8; i += 1) {
+            sum += read_vec2f(&reader).x;
+        }
+
+        return (u64) sum;
+    });
+
+    bench_run(context, "commands/read_array_mat4f_4096", 100, [&]() {
+        auto reader = create_command_reader(&buffer[0], sizeof(buffer));
+        u8 const* matrices = read_array(&reader, BENCH_MATRICES_COUNT, sizeof(Mat4f));
+        f32 sum = 0.f;
+
+        for (u64 i = 0; i < BENCH_MATRICES_COUNT; i += 1) {
+            const Mat4f matrix = load_mat4f(matrices + i * sizeof(Mat4f));
+            f32 values[16];
+
+            memcpy(&values[0], &matrix, sizeof(values));
+            sum += values[3];
+        }
+
+        return (u64) sum;
+    });
+}
@@ -0,0 +1,95 @@
+#include "bench.hpp"
+#include "memory.hpp"
+#include "frame_allocator.hpp"
+
+void bench_memory(BenchContext const& context) {
+    auto region_result = create_region_memory_buffer(megabytes(16));
+    RegionMemoryBuffer region = result_unwrap(region_result);
+
+    bench_run(context, "memory/region_alloc_64", 100000, [&]() {
+        if (region.offset + 64 > region.size) {
+            region_memory_buffer_free(&region);
+        }
+
+        auto alloc_result = region_memory_buffer_alloc(&region, 64);
+        return (u64) (umm) result_get_payload(alloc_result);
+    });
+
+    region_memory_buffer_free(&region);
+
+    bench_run(context, "memory/region_alloc_4k", 10000, [&]() {
+        if (region.offset + kilobytes(4) > region.size) {
+            region_memory_buffer_free(&region);
+        }
+
+        auto alloc_result = region_memory_buffer_alloc(&region, kilobytes(4));
+        return (u64) (umm) result_get_payload(alloc_result);
+    });
+
+    region_memory_buffer_free(&region);
+
+    bench_run(context, "memory/region_push_mat4f_16", 100000, [&]() {
+        if (region.offset + sizeof(Mat4f) * 16 > region.size) {
+            region_memory_buffer_free(&region);
+        }
+
+        auto push_result = region_push<Mat4f>(&region, 16);
+        return (u64) (umm) result_get_payload(push_result);
+    });
+
+    region_memory_buffer_free(&region);
+
+    auto pool_result = create_pool_memory_buffer(&region, 1024, 256);
+    PoolMemoryBuffer pool = result_unwrap(pool_result);
+
+    bench_run(context, "memory/pool_alloc_free", 100000, [&]() {
+        auto alloc_result = pool_memory_buffer_alloc(&pool);
+        u8* block = result_get_payload(alloc_result);
+        pool_memory_buffer_free(&pool, block);
+        return (u64) (umm) block;
+    });
+
+    auto stack_result = create_stack_memory_buffer(&region, megabytes(1));
+    StackMemoryBuffer stack = result_unwrap(stack_result);
+
+    bench_run(context, "memory/stack_alloc_rollback", 100000, [&]() {
+        const StackMarker marker = stack_memory_buffer_get_marker(&stack);
+        auto alloc_result = stack_memory_buffer_alloc(&stack, 256);
+        u8* data = result_get_payload(alloc_result);
+        stack_memory_buffer_rollback(&stack, marker);
+        return (u64) (umm) data;
+    });
+
+    FrameAllocator frame_allocator;
+    frame_allocator_init(&frame_allocator, &region, megabytes(1));
+
+    bench_run(context, "memory/frame_alloc_256x64", 10000, [&]() {
+        frame_allocator_begin_frame(&frame_allocator);
+        u64 checksum = 0;
+
+        for (u32 i = 0; i < 64; i += 1) {
+            auto alloc_result = frame_allocator_alloc(&frame_allocator, 256, MEMORY_DEFAULT_ALIGNMENT);
+            checksum += (u64) (umm) result_get_payload(alloc_result);
+        }
+
+        return checksum;
+    });
+
+    frame_allocator_free(&frame_allocator);
+
+    auto growable_result = create_growable_region_memory_buffer(megabytes(1), megabytes(16));
+    GrowableRegionMemoryBuffer growable = result_unwrap(growable_result);
+
+    bench_run(context, "memory/growable_alloc_4k", 10000, [&]() {
+        auto alloc_result = growable_region_memory_buffer_alloc(&growable, kilobytes(4));
+
+        if (result_has_error(alloc_result)) {
+            growable_region_memory_buffer_free(&growable);
+            alloc_result = growable_region_memory_buffer_alloc(&growable, kilobytes(4));
+        }
+
+        return (u64) (umm) result_get_payload(alloc_result);
+    });
+
+    growable_region_memory_buffer_free(&growable);
+}
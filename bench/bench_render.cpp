@@ -0,0 +1,122 @@
+#include "bench.hpp"
+#include "gapi.hpp"
+
+static const u64 BENCH_COMMANDS_BUFFER_SIZE = megabytes(4);
+static const char* BENCH_ADDRESS = "tech.paws.client";
+
+extern MutBytesBuffer bench_vm_commands_buffer;
+
+static u64 build_quads_frame(u8* base, u64 size, u64 commands, u64 quads_per_command) {
+    CommandsBuilder builder = commands_builder_create(base, size, BENCH_ADDRESS);
+
+    for (u64 i = 0; i < commands; i += 1) {
+        commands_builder_begin(&builder, COMMAND_GAPI_SET_COLOR_PIPELINE);
+        commands_builder_write_f32(&builder, (i % 3) / 3.f);
+        commands_builder_write_f32(&builder, 0.5f);
+        commands_builder_write_f32(&builder, 1.f);
+        commands_builder_write_f32(&builder, 1.f);
+        commands_builder_end(&builder);
+
+        commands_builder_begin(&builder, i % 2 == 0 ? COMMAND_GAPI_DRAW_QUADS : COMMAND_GAPI_DRAW_CENTERED_QUADS);
+        commands_builder_write_i64(&builder, quads_per_command);
+
+        for (u64 j = 0; j < quads_per_command; j += 1) {
+            commands_builder_write_mat4f(&builder, j * 0.001f, i * 0.01f, 0.01f);
+        }
+
+        commands_builder_end(&builder);
+    }
+
+    return commands_builder_finish(&builder);
+}
+
+static u64 build_lines_frame(u8* base, u64 size, u64 points) {
+    CommandsBuilder builder = commands_builder_create(base, size, BENCH_ADDRESS);
+
+    commands_builder_begin(&builder, COMMAND_GAPI_DRAW_PATH);
+    commands_builder_write_mat4f(&builder, 0.f, 0.f, 1.f);
+    commands_builder_write_i64(&builder, points);
+
+    for (u64 i = 0; i < points; i += 1) {
+        commands_builder_write_f32(&builder, (f32) i / points);
+        commands_builder_write_f32(&builder, (i % 2) * 0.5f);
+    }
+
+    commands_builder_end(&builder);
+
+    commands_builder_begin(&builder, COMMAND_GAPI_DRAW_LINES);
+    commands_builder_write_mat4f(&builder, 0.f, 0.f, 1.f);
+    commands_builder_write_i64(&builder, points);
+
+    for (u64 i = 0; i < points; i += 1) {
+        commands_builder_write_f32(&builder, (i % 2) * 0.5f);
+        commands_builder_write_f32(&builder, (f32) i / points);
+    }
+
+    commands_builder_end(&builder);
+    return commands_builder_finish(&builder);
+}
+
+static u64 build_texts_frame(u8* base, u64 size, u64 texts) {
+    CommandsBuilder builder = commands_builder_create(base, size, BENCH_ADDRESS);
+
+    commands_builder_begin(&builder, COMMAND_GAPI_DRAW_TEXTS);
+    commands_builder_write_string(&builder, BENCH_ADDRESS);
+    commands_builder_write_i64(&builder, texts);
+
+    for (u64 i = 0; i < texts; i += 1) {
+        commands_builder_write_i64(&builder, 0);
+        commands_builder_write_i32(&builder, i % 2 == 0 ? 14 : 24);
+        commands_builder_write_mat4f(&builder, 0.f, i * 0.01f, 0.001f);
+        commands_builder_write_string(&builder, "The quick brown fox jumps over the lazy dog 0123456789");
+    }
+
+    commands_builder_end(&builder);
+    return commands_builder_finish(&builder);
+}
+
+static FrameAllocator bench_frame_allocator;
+
+static void bench_render_frame(BenchContext const& context, const char* name, u8* base, u64 size, u64 iterations) {
+    bench_vm_commands_buffer.base = base;
+    bench_vm_commands_buffer.size = size;
+
+    Platform& platform = *context.platform;
+    Window& window = *context.window;
+
+    bench_run(context, name, iterations, [&]() {
+        frame_allocator_begin_frame(&bench_frame_allocator);
+        gapi_clear(0.0f, 0.0f, 0.0f);
+        gapi_render(platform.gapi);
+        gapi_set_viewport(platform.gapi, 0, 0, context.config.window_width, context.config.window_height);
+        gapi_swap_window(platform, window);
+
+        return gapi_get_frame_stats(platform.gapi).draw_calls;
+    });
+}
+
+void bench_render(BenchContext const& context) {
+    static u8 buffer[BENCH_COMMANDS_BUFFER_SIZE];
+    u64 size;
+
+    auto region_result = create_region_memory_buffer(region_memory_buffer_sub_region_size(megabytes(5)) * FRAME_ALLOCATOR_FRAMES);
+    RegionMemoryBuffer region = result_unwrap(region_result);
+
+    frame_allocator_init(&bench_frame_allocator, &region, megabytes(5));
+    gapi_set_frame_allocator(context.platform->gapi, &bench_frame_allocator);
+
+    size = build_quads_frame(&buffer[0], BENCH_COMMANDS_BUFFER_SIZE, 100, 100);
+    bench_render_frame(context, "render/frame_quads_100x100", &buffer[0], size, 50);
+
+    size = build_quads_frame(&buffer[0], BENCH_COMMANDS_BUFFER_SIZE, 1000, 1);
+    bench_render_frame(context, "render/frame_quads_1000x1", &buffer[0], size, 50);
+
+    size = build_lines_frame(&buffer[0], BENCH_COMMANDS_BUFFER_SIZE, 10000);
+    bench_render_frame(context, "render/frame_lines_10000", &buffer[0], size, 50);
+
+    size = build_texts_frame(&buffer[0], BENCH_COMMANDS_BUFFER_SIZE, 200);
+    bench_render_frame(context, "render/frame_texts_200", &buffer[0], size, 50);
+
+    gapi_set_frame_allocator(context.platform->gapi, nullptr);
+    frame_allocator_free(&bench_frame_allocator);
+}
@@ -0,0 +1,8 @@
+#include "../build.cpp"
+
+#include "vm_stubs.cpp"
+#include "bench_memory.cpp"
+#include "bench_commands.cpp"
+#include "bench_assets.cpp"
+#include "bench_render.cpp"
+#include "main.cpp"
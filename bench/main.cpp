@@ -0,0 +1,52 @@
+#include "bench.hpp"
+#include "shell.hpp"
+#include "jobs.hpp"
+
+// Usage: bench [--assets <path>] [--filter <substring>] [--workers <count>] [--huge-pages <0|1|2>]
+int main(int argc, char** argv) {
+    BenchContext context = {};
+    context.config.size = sizeof(ShellConfig);
+    context.config.assets_path = "assets";
+    context.config.window_title = "Bench";
+    context.config.window_width = 1280;
+    context.config.window_height = 720;
+    context.config.headless = true;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--assets") == 0) {
+            context.config.assets_path = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--filter") == 0) {
+            context.filter = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--workers") == 0) {
+            context.config.worker_threads = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--huge-pages") == 0) {
+            context.config.huge_pages = atoi(argv[i + 1]);
+        }
+    }
+
+    platform_set_huge_pages((PlatformHugePages) context.config.huge_pages);
+
+    bench_memory(context);
+    bench_commands(context);
+    bench_assets(context);
+
+    result_unwrap(job_system_init(context.config.worker_threads));
+
+    auto assets_buffer = result_unwrap(create_growable_region_memory_buffer(SHELL_ASSETS_BLOCK_SIZE, SHELL_ASSETS_MEMORY_DEFAULT));
+    auto platform = result_unwrap(platform_init(context.config));
+    auto window = result_unwrap(platform_create_window(context.config, platform, &assets_buffer));
+
+    context.platform = &platform;
+    context.window = &window;
+
+    bench_render(context);
+
+    platform_destroy_window(window);
+    platform_shutdown(platform);
+    job_system_shutdown();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#include "vm.hpp"
+#include "bench.hpp"
+
+// Minimal VM to run the shell without the VM process, commands sent to the VM are dropped.
+
+static const size_t BENCH_VM_SCRATCH_SIZE = 64 * 1024;
+
+static u8 bench_vm_scratch[BENCH_VM_SCRATCH_SIZE];
+static BytesWriter bench_vm_writer;
+
+MutBytesBuffer bench_vm_commands_buffer = {
+    .size = 0,
+    .base = nullptr,
+};
+
+extern "C" void tech_paws_vm_init() {
+}
+
+extern "C" bool tech_paws_vm_process_commands() {
+    return true;
+}
+
+extern "C" void tech_paws_vm_process_render_commands() {
+}
+
+extern "C" Commands tech_paws_vm_get_commands() {
+    return Commands { .data = nullptr, .size = 0 };
+}
+
+extern "C" Commands tech_paws_vm_get_gapi_commands() {
+    return Commands { .data = nullptr, .size = 0 };
+}
+
+extern "C" BytesBuffer tech_paws_vm_client_id() {
+    return BytesBuffer { .size = 0, .base = nullptr };
+}
+
+extern "C" void tech_paws_vm_gapi_flush() {
+}
+
+extern "C" void tech_paws_vm_process_flush() {
+}
+
+extern "C" void tech_paws_vm_flush() {
+}
+
+extern "C" void tech_paws_push_command(char const* address, Command command, Source source) {
+}
+
+extern "C" void tech_paws_vm_log_trace(char const* message) {
+}
+
+extern "C" void tech_paws_vm_log_error(char const* message) {
+    fprintf(stderr, "error: %s\n", message);
+}
+
+extern "C" void tech_paws_vm_log_warn(char const* message) {
+    fprintf(stderr, "warning: %s\n", message);
+}
+
+extern "C" void tech_paws_vm_log_debug(char const* message) {
+}
+
+extern "C" void tech_paws_vm_log_info(char const* message) {
+}
+
+extern "C" MutBytesBuffer tech_paws_vm_get_commands_buffer() {
+    return bench_vm_commands_buffer;
+}
+
+extern "C" BytesWriter* tech_paws_begin_command(char const* to, Source source, u64 id) {
+    bench_vm_writer = vm_buffers_create_bytes_writer(ByteOrder::LittleEndian, &bench_vm_scratch[0], BENCH_VM_SCRATCH_SIZE);
+    return &bench_vm_writer;
+}
+
+extern "C" void tech_paws_end_command(char const* to, Source source) {
+}
@@ -4,18 +4,39 @@
 
 #ifdef GAPI_OPENGL
 #include "src/gapi/opengl.cpp"
+#include "src/gapi/opengl_stream_buffer.cpp"
+#include "src/gapi/opengl_state.cpp"
+#include "src/gapi/opengl_gpu_timer.cpp"
+#include "src/gapi/opengl_prepare.cpp"
 
     #ifdef PLATFORM_SDL2
     #include "src/gapi/opengl_sdl2.cpp"
+        #ifdef GAPI_HEADLESS
+        #include "src/gapi/opengl_headless.cpp"
+        #endif
+    #include "src/gapi/opengl_glyph_atlas.cpp"
     #endif
 
 #endif
 
+#ifdef GAPI_NULL
+#include "src/gapi/null.cpp"
+#endif
+
 #ifdef __linux__
 #include "src/platform/linux.cpp"
 #endif
 
 #include "src/assets.cpp"
+#include "src/asset_loader.cpp"
+#include "src/texture_registry.cpp"
 #include "src/memory.cpp"
+#include "src/memory_tracking.cpp"
+#include "src/frame_allocator.cpp"
+#include "src/frame_scheduler.cpp"
+#include "src/frame_stats.cpp"
+#include "src/profiler.cpp"
+#include "src/jobs.cpp"
+#include "src/recorder.cpp"
 #include "src/shell.cpp"
 #include "src/lib.cpp"
@@ -0,0 +1,312 @@
+#include "asset_loader.hpp"
+#include "assets.hpp"
+#include "gapi/commands.hpp"
+#include "platform.hpp"
+#include "profiler.hpp"
+#include "log.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+struct AssetRequest {
+    char name[GAPI_ADDRESS_CAPACITY];
+};
+
+enum class AssetSlotState {
+    free,
+    decoding,
+    decoded,
+    failed,
+    uploading,
+};
+
+// NOTE: Workers only touch slots in the decoding state, the main thread all the others
+struct AssetSlot {
+    AssetSlotState state;
+    AssetRequest request;
+    GrowableRegionMemoryBuffer staging;
+    AssetData data;
+    GeneralError error;
+    Texture2D texture;
+    u32 uploaded_rows;
+};
+
+struct AssetLoader {
+    ShellConfig config;
+    std::thread threads[ASSET_LOADER_THREADS];
+    u32 threads_count;
+    bool running;
+    std::mutex mutex;
+    std::condition_variable wake;
+    AssetRequest queue[ASSET_LOADER_QUEUE_CAPACITY];
+    u32 queue_head;
+    u32 queue_count;
+    AssetSlot slots[ASSET_LOADER_SLOTS];
+    u32 slots_count;
+};
+
+static AssetLoader asset_loader;
+
+static const Texture2DParameters asset_loader_texture_params = {
+    .wrap_s = false,
+    .wrap_t = false,
+    .min_filter = true,
+    .mag_filter = true,
+};
+
+// Takes the next request into a free slot, should be called with the mutex locked.
+static AssetSlot* asset_loader_take_request() {
+    if (asset_loader.queue_count == 0) {
+        return nullptr;
+    }
+
+    for (u32 i = 0; i < asset_loader.slots_count; i += 1) {
+        AssetSlot* slot = &asset_loader.slots[i];
+
+        if (slot->state == AssetSlotState::free) {
+            slot->request = asset_loader.queue[asset_loader.queue_head];
+            slot->state = AssetSlotState::decoding;
+
+            asset_loader.queue_head = (asset_loader.queue_head + 1) % ASSET_LOADER_QUEUE_CAPACITY;
+            asset_loader.queue_count -= 1;
+
+            return slot;
+        }
+    }
+
+    return nullptr;
+}
+
+static void asset_loader_decode(AssetSlot* slot) {
+    PROFILE_ZONE("asset_loader_decode");
+
+    const auto data_result = asset_load_data(asset_loader.config, &slot->staging, AssetType::texture, slot->request.name);
+
+    std::lock_guard<std::mutex> lock(asset_loader.mutex);
+
+    if (result_has_error(data_result)) {
+        slot->error = data_result.error;
+        slot->state = AssetSlotState::failed;
+    }
+    else {
+        slot->data = result_get_payload(data_result);
+        slot->state = AssetSlotState::decoded;
+    }
+}
+
+static void asset_loader_worker() {
+    while (true) {
+        AssetSlot* slot;
+
+        {
+            std::unique_lock<std::mutex> lock(asset_loader.mutex);
+            asset_loader.wake.wait(lock, [&slot]() {
+                slot = asset_loader.running ? asset_loader_take_request() : nullptr;
+                return slot != nullptr || !asset_loader.running;
+            });
+
+            if (!asset_loader.running) {
+                return;
+            }
+        }
+
+        asset_loader_decode(slot);
+    }
+}
+
+static void asset_loader_stop(u32 started_threads) {
+    {
+        std::lock_guard<std::mutex> lock(asset_loader.mutex);
+        asset_loader.running = false;
+    }
+
+    asset_loader.wake.notify_all();
+
+    for (u32 i = 0; i < started_threads; i += 1) {
+        asset_loader.threads[i].join();
+    }
+
+    asset_loader.threads_count = 0;
+}
+
+Result<bool> asset_loader_init(ShellConfig const& config) {
+    asset_loader.config = config;
+    asset_loader.queue_head = 0;
+    asset_loader.queue_count = 0;
+    asset_loader.slots_count = 0;
+
+    for (u32 i = 0; i < ASSET_LOADER_SLOTS; i += 1) {
+        auto staging_result = create_reserved_growable_region_memory_buffer(ASSET_LOADER_STAGING_BLOCK_SIZE, ASSET_LOADER_STAGING_SIZE);
+
+        if (result_has_error(staging_result)) {
+            return switch_error<bool>(staging_result);
+        }
+
+        AssetSlot* slot = &asset_loader.slots[i];
+        slot->state = AssetSlotState::free;
+        slot->staging = result_get_payload(staging_result);
+        asset_loader.slots_count += 1;
+    }
+
+    asset_loader.running = true;
+
+    for (u32 i = 0; i < ASSET_LOADER_THREADS; i += 1) {
+        try {
+            asset_loader.threads[i] = std::thread(asset_loader_worker);
+        }
+        catch (std::system_error const& error) {
+            asset_loader_stop(i);
+
+            return result_create_general_error<bool>(
+                ErrorCode::AssetLoaderInit,
+                "Can't start asset loader thread: %s", error.what()
+            );
+        }
+
+        asset_loader.threads_count += 1;
+    }
+
+    return result_create_success(true);
+}
+
+void asset_loader_shutdown() {
+    asset_loader_stop(asset_loader.threads_count);
+
+    for (u32 i = 0; i < asset_loader.slots_count; i += 1) {
+        growable_region_memory_buffer_destroy(&asset_loader.slots[i].staging);
+    }
+
+    asset_loader.slots_count = 0;
+}
+
+bool asset_loader_request_texture(char const* name) {
+    {
+        std::lock_guard<std::mutex> lock(asset_loader.mutex);
+
+        if (asset_loader.queue_count == ASSET_LOADER_QUEUE_CAPACITY) {
+            return false;
+        }
+
+        AssetRequest* request = &asset_loader.queue[(asset_loader.queue_head + asset_loader.queue_count) % ASSET_LOADER_QUEUE_CAPACITY];
+        copy_address(&request->name[0], (u8 const*) name, strlen(name));
+        asset_loader.queue_count += 1;
+    }
+
+    asset_loader.wake.notify_one();
+    return true;
+}
+
+static void asset_loader_free_slot(AssetSlot* slot) {
+    // NOTE: Staging of a big texture shouldn't stay committed until the next one
+    growable_region_memory_buffer_free(&slot->staging);
+
+    {
+        std::lock_guard<std::mutex> lock(asset_loader.mutex);
+        slot->state = AssetSlotState::free;
+    }
+
+    asset_loader.wake.notify_one();
+}
+
+// Returns false when the budget is spent before the texture is uploaded.
+static bool asset_loader_upload(GApi& gapi, AssetSlot* slot, f64 start_time, f64 budget_ms, bool* uploaded_chunk) {
+    const TextureHeader header = *((TextureHeader*) slot->data.data);
+    u8 const* pixels = slot->data.data + sizeof(TextureHeader);
+    const u64 row_size = (u64) header.width * texture_format_pixel_size(header.format);
+    const u32 chunk_rows = row_size >= ASSET_LOADER_UPLOAD_CHUNK ? 1 : (u32) (ASSET_LOADER_UPLOAD_CHUNK / row_size);
+
+    if (slot->state == AssetSlotState::decoded) {
+        slot->texture = gapi_create_empty_texture_2d(gapi, header, asset_loader_texture_params);
+        slot->uploaded_rows = 0;
+
+        std::lock_guard<std::mutex> lock(asset_loader.mutex);
+        slot->state = AssetSlotState::uploading;
+    }
+
+    while (slot->uploaded_rows < header.height) {
+        if (*uploaded_chunk && platform_get_ticks() - start_time >= budget_ms) {
+            return false;
+        }
+
+        const u32 rows_left = header.height - slot->uploaded_rows;
+        const u32 rows_count = rows_left < chunk_rows ? rows_left : chunk_rows;
+
+        gapi_upload_texture_2d_rows(gapi, slot->texture, header, slot->uploaded_rows, rows_count, pixels + slot->uploaded_rows * row_size);
+        slot->uploaded_rows += rows_count;
+        *uploaded_chunk = true;
+    }
+
+    return true;
+}
+
+void asset_loader_update(GApi& gapi, f64 budget_ms, AssetTextureLoaded texture_loaded) {
+    PROFILE_FUNCTION();
+
+    const f64 start_time = platform_get_ticks();
+    bool uploaded_chunk = false;
+    AssetSlotState states[ASSET_LOADER_SLOTS];
+
+    // NOTE: Without threads one asset per call is decoded here, so requests still complete
+    if (asset_loader.threads_count == 0) {
+        AssetSlot* slot;
+
+        {
+            std::lock_guard<std::mutex> lock(asset_loader.mutex);
+            slot = asset_loader_take_request();
+        }
+
+        if (slot != nullptr) {
+            asset_loader_decode(slot);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(asset_loader.mutex);
+
+        for (u32 i = 0; i < asset_loader.slots_count; i += 1) {
+            states[i] = asset_loader.slots[i].state;
+        }
+    }
+
+    for (u32 i = 0; i < asset_loader.slots_count; i += 1) {
+        AssetSlot* slot = &asset_loader.slots[i];
+
+        switch (states[i]) {
+            case AssetSlotState::failed:
+                log_error(slot->error.message);
+                texture_loaded(gapi, slot->request.name, nullptr);
+                asset_loader_free_slot(slot);
+                break;
+
+            case AssetSlotState::decoded:
+            case AssetSlotState::uploading:
+                if (!asset_loader_upload(gapi, slot, start_time, budget_ms, &uploaded_chunk)) {
+                    return;
+                }
+
+                texture_loaded(gapi, slot->request.name, &slot->texture);
+                asset_loader_free_slot(slot);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+bool asset_loader_pending() {
+    std::lock_guard<std::mutex> lock(asset_loader.mutex);
+
+    if (asset_loader.queue_count != 0) {
+        return true;
+    }
+
+    for (u32 i = 0; i < asset_loader.slots_count; i += 1) {
+        if (asset_loader.slots[i].state != AssetSlotState::free) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "gapi.hpp"
+#include "shell_config.hpp"
+
+// Threads that read and decode assets, separate from the job system,
+// so long decoding doesn't hold up jobs the main thread waits for.
+static const u32 ASSET_LOADER_THREADS = 2;
+
+// Decoded assets waiting for upload, each has its own staging region
+static const u32 ASSET_LOADER_SLOTS = 4;
+
+// NOTE: Requests that don't fit into the queue are reported as failed right away
+static const u32 ASSET_LOADER_QUEUE_CAPACITY = 256;
+
+// Budget of a staging region, the biggest texture that can be loaded
+static const u64 ASSET_LOADER_STAGING_SIZE = megabytes(64);
+
+// NOTE: Textures bigger than a block get a block of their own, it's returned when the slot is freed
+static const u64 ASSET_LOADER_STAGING_BLOCK_SIZE = megabytes(2);
+
+// Bytes uploaded to the GPU at once, the upload budget is checked between chunks
+static const u64 ASSET_LOADER_UPLOAD_CHUNK = kilobytes(256);
+
+// Upload time per frame when ShellConfig doesn't set it
+static const f64 ASSET_LOADER_UPLOAD_BUDGET_DEFAULT = 2.0;
+
+// Called on the main thread when the texture is uploaded, texture is nullptr when it has failed.
+typedef void (*AssetTextureLoaded)(GApi& gapi, char const* name, Texture2D const* texture);
+
+// When threads can't be started assets are decoded by asset_loader_update, one per call.
+Result<bool> asset_loader_init(ShellConfig const& config);
+
+void asset_loader_shutdown();
+
+// Queues the texture, it is reported by asset_loader_update when it is ready,
+// returns false if the queue is full.
+bool asset_loader_request_texture(char const* name);
+
+// Uploads decoded textures until budget_ms is spent, at least one chunk per call,
+// and reports finished ones. Should be called on the thread that owns the GAPI context.
+void asset_loader_update(GApi& gapi, f64 budget_ms, AssetTextureLoaded texture_loaded);
+
+// Returns true while requested textures are queued, decoding or waiting for upload.
+bool asset_loader_pending();
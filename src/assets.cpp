@@ -2,10 +2,12 @@
 #include "platform.hpp"
 #include "shell_config.hpp"
 #include "log.hpp"
+#include "memory_tracking.hpp"
 #include <jpeglib.h>
 #include <setjmp.h>
 
-static Result<AssetData> load_shader(ShellConfig const& config, RegionMemoryBuffer* dest_memory, const char* asset_name) {
+static Result<AssetData> load_shader(ShellConfig const& config, GrowableRegionMemoryBuffer* dest_memory, const char* asset_name) {
+    MEMORY_TAG("assets/shader");
     char path[1024] { 0 };
     char relative_path[1024] { 0 };
 
@@ -26,7 +28,7 @@ static Result<AssetData> load_shader(ShellConfig const& config, RegionMemoryBuff
     rewind(file);
 
     // NOTE(sysint64): +1 for terminate symbol \0
-    Result<u8*> data_result = region_memory_buffer_alloc(dest_memory, size + 1);
+    Result<u8*> data_result = growable_region_memory_buffer_alloc(dest_memory, size + 1);
 
     if (result_has_error(data_result)) {
         return switch_error<AssetData>(data_result);
@@ -53,7 +55,7 @@ static Result<AssetData> load_shader(ShellConfig const& config, RegionMemoryBuff
     return result_create_success(asset_data);
 }
 
-static Result<AssetData> load_png_texture(ShellConfig const& config, RegionMemoryBuffer* dest_memory, const char* asset_name) {
+static Result<AssetData> load_png_texture(ShellConfig const& config, GrowableRegionMemoryBuffer* dest_memory, const char* asset_name) {
     return result_create_general_error<AssetData>(
         ErrorCode::LoadAsset,
         "PNG Not implemented yet"
@@ -65,7 +67,8 @@ struct JpegErrorMgr {
     jmp_buf set_jmp_buffer;
 };
 
-static char jpeg_last_error_msg[JMSG_LENGTH_MAX] {};
+// NOTE: Textures are decoded on the asset loader threads
+static thread_local char jpeg_last_error_msg[JMSG_LENGTH_MAX] {};
 
 METHODDEF(void) jpegErrorExit (j_common_ptr cinfo) {
     JpegErrorMgr* err = (JpegErrorMgr*) cinfo->err;
@@ -73,7 +76,7 @@ METHODDEF(void) jpegErrorExit (j_common_ptr cinfo) {
     longjmp(err->set_jmp_buffer, 1);
 }
 
-static Result<AssetData> load_jpeg_texture(ShellConfig const& config, RegionMemoryBuffer* dest_memory, const char* asset_name) {
+static Result<AssetData> load_jpeg_texture(ShellConfig const& config, GrowableRegionMemoryBuffer* dest_memory, const char* asset_name) {
     char path[1024] { 0 };
     char relative_path[1024] { 0 };
 
@@ -109,6 +112,8 @@ static Result<AssetData> load_jpeg_texture(ShellConfig const& config, RegionMemo
     jpeg_stdio_src(&cinfo, infile);
     jpeg_read_header(&cinfo, 0);
 
+    // NOTE: Textures are uploaded as rgb, so grayscale images are converted
+    cinfo.out_color_space = JCS_RGB;
     jpeg_start_decompress(&cinfo);
 
     const u32 width = cinfo.output_width;
@@ -120,9 +125,12 @@ static Result<AssetData> load_jpeg_texture(ShellConfig const& config, RegionMemo
 
     const u64 texture_size = width * height * depth;
     const u64 size = sizeof(TextureHeader) + texture_size;
-    const auto data_result = region_memory_buffer_alloc(dest_memory, size);
+    const auto data_result = growable_region_memory_buffer_alloc(dest_memory, size);
 
     if (result_has_error(data_result)) {
+        jpeg_destroy_decompress(&cinfo);
+        fclose(infile);
+
         return switch_error<AssetData>(data_result);
     }
 
@@ -156,7 +164,8 @@ static Result<AssetData> load_jpeg_texture(ShellConfig const& config, RegionMemo
     return result_create_success(asset_data);
 }
 
-static Result<AssetData> load_texture(ShellConfig const& config, RegionMemoryBuffer* dest_memory, const char* asset_name) {
+static Result<AssetData> load_texture(ShellConfig const& config, GrowableRegionMemoryBuffer* dest_memory, const char* asset_name) {
+    MEMORY_TAG("assets/texture");
     const char* dot;
     dot = strrchr(asset_name, '.');
 
@@ -183,7 +192,7 @@ static Result<AssetData> load_texture(ShellConfig const& config, RegionMemoryBuf
 
 Result<AssetData> asset_load_data(
     ShellConfig const& config,
-    RegionMemoryBuffer* dest_memory,
+    GrowableRegionMemoryBuffer* dest_memory,
     const AssetType assetType,
     const char* asset_name
 ) {
@@ -29,9 +29,13 @@ struct TextureHeader {
     TextureFormat format;
 };
 
+static inline u32 texture_format_pixel_size(TextureFormat format) {
+    return format == TextureFormat::rgba ? 4 : 3;
+}
+
 Result<AssetData> asset_load_data(
     ShellConfig const& config,
-    RegionMemoryBuffer* dest_memory,
+    GrowableRegionMemoryBuffer* dest_memory,
     const AssetType asset_type,
     const char* asset_name
 );
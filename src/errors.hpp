@@ -14,4 +14,10 @@ enum class ErrorCode {
     GApiShaderStatus,
     GApiShaderProgramStatus,
     GApiShaderUniformLocation,
+    ProfilerExport,
+    GApiReadFrame,
+    Recording,
+    JobSystemInit,
+    AssetLoaderInit,
+    TextureRegistryInit,
 };
@@ -0,0 +1,109 @@
+#include "frame_allocator.hpp"
+#include "platform.hpp"
+#include "log.hpp"
+#include "memory_tracking.hpp"
+
+// NOTE: Payload of an overflow block starts after a cache line with the header
+static_assert(sizeof(FrameOverflowBlock) <= MEMORY_CACHE_LINE_SIZE, "Overflow header should fit into a cache line");
+
+void frame_allocator_init(FrameAllocator* allocator, RegionMemoryBuffer* root, u64 frame_size) {
+    *allocator = {};
+
+    for (u32 i = 0; i < FRAME_ALLOCATOR_FRAMES; i += 1) {
+        region_memory_buffer_add_region(root, &allocator->frames[i], frame_size);
+    }
+
+    allocator->stats.frame_size = frame_size;
+}
+
+static void frame_allocator_free_overflow(FrameAllocator* allocator, u32 frame_index) {
+    FrameOverflowBlock* block = allocator->overflow[frame_index];
+
+    while (block != nullptr) {
+        FrameOverflowBlock* next = block->next;
+        platform_free((u8*) block, block->size);
+        block = next;
+    }
+
+    allocator->overflow[frame_index] = nullptr;
+}
+
+void frame_allocator_begin_frame(FrameAllocator* allocator) {
+    const RegionMemoryBuffer& frame = allocator->frames[allocator->frame_index];
+    const u64 used = frame.offset + allocator->frame_overflow_bytes;
+
+    if (used > allocator->stats.high_water) {
+        allocator->stats.high_water = used;
+    }
+
+    if (frame.offset > allocator->trim_peak) {
+        allocator->trim_peak = frame.offset;
+    }
+
+    allocator->trim_frames += 1;
+
+    if (allocator->trim_frames == FRAME_ALLOCATOR_TRIM_FRAMES) {
+        allocator->trim_size = allocator->trim_peak;
+        allocator->trim_pending = FRAME_ALLOCATOR_FRAMES;
+        allocator->trim_peak = 0;
+        allocator->trim_frames = 0;
+    }
+
+    allocator->frame_index = (allocator->frame_index + 1) % FRAME_ALLOCATOR_FRAMES;
+    allocator->frame_overflow_bytes = 0;
+
+    frame_allocator_free_overflow(allocator, allocator->frame_index);
+
+    if (allocator->trim_pending > 0) {
+        region_memory_buffer_release(&allocator->frames[allocator->frame_index], allocator->trim_size);
+        allocator->trim_pending -= 1;
+    }
+    else {
+        region_memory_buffer_free(&allocator->frames[allocator->frame_index]);
+    }
+}
+
+Result<u8*> frame_allocator_alloc(FrameAllocator* allocator, u64 size, u64 alignment) {
+    assert(alignment <= MEMORY_CACHE_LINE_SIZE);
+
+    const u32 frame_index = allocator->frame_index;
+    const auto data_result = region_memory_buffer_alloc_aligned(&allocator->frames[frame_index], size, alignment);
+
+    if (result_is_success(data_result)) {
+        return data_result;
+    }
+
+    const u64 block_size = MEMORY_CACHE_LINE_SIZE + size;
+    auto block = (FrameOverflowBlock*) platform_alloc(block_size);
+
+    if (block == nullptr) {
+        return result_create_general_error<u8*>(
+            ErrorCode::Allocation,
+            "Frame allocator overflow of %llu bytes has failed", (unsigned long long) size
+        );
+    }
+
+    // NOTE: Reported once per frame to not flood the log
+    if (allocator->frame_overflow_bytes == 0) {
+        log_warn("Frame memory of %llu bytes is exhausted, falling back to platform_alloc", (unsigned long long) allocator->stats.frame_size);
+    }
+
+    block->next = allocator->overflow[frame_index];
+    block->size = block_size;
+    allocator->overflow[frame_index] = block;
+
+    // NOTE: Tracked as part of the frame region, so they are freed with it
+    MEMORY_TRACK_ALLOC(allocator->frames[frame_index].base, allocator->frames[frame_index].size, size);
+
+    allocator->frame_overflow_bytes += size;
+    allocator->stats.overflow_allocations += 1;
+    allocator->stats.overflow_bytes += size;
+
+    return result_create_success((u8*) block + MEMORY_CACHE_LINE_SIZE);
+}
+
+void frame_allocator_free(FrameAllocator* allocator) {
+    for (u32 i = 0; i < FRAME_ALLOCATOR_FRAMES; i += 1) {
+        frame_allocator_free_overflow(allocator, i);
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "memory.hpp"
+
+static const u32 FRAME_ALLOCATOR_FRAMES = 2;
+
+// Every this number of frames pages that regions haven't used during the period
+// are returned to the OS, so a single heavy frame doesn't hold memory forever.
+static const u32 FRAME_ALLOCATOR_TRIM_FRAMES = 600;
+
+// Allocation that didn't fit into the frame region, freed when its frame
+// region is reused.
+struct FrameOverflowBlock {
+    FrameOverflowBlock* next;
+    u64 size;
+};
+
+struct FrameAllocatorStats {
+    u64 frame_size;
+    // Max bytes used by a single frame since creation, including overflow
+    u64 high_water;
+    u64 overflow_allocations;
+    u64 overflow_bytes;
+};
+
+// Linear allocator for transient frame data. Frames use regions in turns,
+// so data of the previous frame stays valid during the current one.
+struct FrameAllocator {
+    RegionMemoryBuffer frames[FRAME_ALLOCATOR_FRAMES];
+    FrameOverflowBlock* overflow[FRAME_ALLOCATOR_FRAMES];
+    u32 frame_index;
+    // Bytes that went to overflow blocks in the current frame
+    u64 frame_overflow_bytes;
+    // Max region usage during the current trim period
+    u64 trim_peak;
+    u32 trim_frames;
+    // Regions left to trim down to trim_size on their next reset
+    u32 trim_pending;
+    u64 trim_size;
+    FrameAllocatorStats stats;
+};
+
+void frame_allocator_init(FrameAllocator* allocator, RegionMemoryBuffer* root, u64 frame_size);
+
+// Switches to the other region and frees everything allocated in it two frames ago.
+void frame_allocator_begin_frame(FrameAllocator* allocator);
+
+// When the frame region is full memory comes from the platform instead of failing,
+// alignment should be a power of two not bigger than MEMORY_CACHE_LINE_SIZE.
+Result<u8*> frame_allocator_alloc(FrameAllocator* allocator, u64 size, u64 alignment);
+
+// Frees all overflow blocks.
+void frame_allocator_free(FrameAllocator* allocator);
+
+template<typename T>
+Result<T*> frame_push(FrameAllocator* allocator, u64 count) {
+    auto data_result = frame_allocator_alloc(allocator, sizeof(T) * count, alignof(T));
+
+    if (result_has_error(data_result)) {
+        return switch_error<T*>(data_result);
+    }
+
+    return result_create_success((T*) result_get_payload(data_result));
+}
@@ -0,0 +1,66 @@
+#include "frame_scheduler.hpp"
+#include "platform.hpp"
+
+void frame_scheduler_init(FrameScheduler* scheduler, f64 step_time, int target_frame_rate) {
+    scheduler->step_time = step_time;
+    scheduler->target_frame_time = target_frame_rate > 0 ? 1000.0 / target_frame_rate : 0.0;
+    scheduler->accumulator = 0.0;
+    scheduler->next_frame_time = 0.0;
+}
+
+u32 frame_scheduler_update(FrameScheduler* scheduler, f64 delta_time) {
+    scheduler->accumulator += delta_time;
+    u32 steps = 0;
+
+    while (scheduler->accumulator >= scheduler->step_time) {
+        scheduler->accumulator -= scheduler->step_time;
+        steps += 1;
+    }
+
+    if (steps > FRAME_SCHEDULER_MAX_STEPS) {
+        steps = FRAME_SCHEDULER_MAX_STEPS;
+    }
+
+    return steps;
+}
+
+void frame_scheduler_wait(FrameScheduler* scheduler) {
+    if (scheduler->target_frame_time <= 0.0) {
+        return;
+    }
+
+    const f64 now = platform_get_ticks();
+
+    // NOTE: Schedule from the previous deadline to not accumulate drift,
+    // unless we are late for more than a frame.
+    if (scheduler->next_frame_time == 0.0 || now - scheduler->next_frame_time > scheduler->target_frame_time) {
+        scheduler->next_frame_time = now;
+    }
+
+    scheduler->next_frame_time += scheduler->target_frame_time;
+    const f64 sleep_time = scheduler->next_frame_time - now - FRAME_SCHEDULER_SPIN_TIME;
+
+    if (sleep_time > 0.0) {
+        platform_sleep(sleep_time);
+    }
+
+    while (platform_get_ticks() < scheduler->next_frame_time) {
+        // Spin
+    }
+}
+
+u32 frame_scheduler_time_to_step(FrameScheduler* scheduler) {
+    const f64 time = scheduler->step_time - scheduler->accumulator;
+
+    if (time <= 0.0) {
+        return 0;
+    }
+
+    // NOTE: Waking up early would only run an iteration without steps
+    return (u32) time + 1;
+}
+
+void frame_scheduler_wake(FrameScheduler* scheduler) {
+    scheduler->accumulator = scheduler->step_time;
+    scheduler->next_frame_time = 0.0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "primitives.hpp"
+
+// Max number of fixed steps per frame, the rest of the accumulated time
+// is dropped so a long stall doesn't cause a burst of steps.
+static const u32 FRAME_SCHEDULER_MAX_STEPS = 8;
+
+// Sleeping is only precise to about a millisecond, the rest of the frame
+// time is spent in a busy wait.
+static const f64 FRAME_SCHEDULER_SPIN_TIME = 2.0;
+
+// All times are in milliseconds.
+struct FrameScheduler {
+    f64 step_time;
+    f64 target_frame_time;
+    f64 accumulator;
+    f64 next_frame_time;
+};
+
+void frame_scheduler_init(FrameScheduler* scheduler, f64 step_time, int target_frame_rate);
+
+// Adds delta time to the accumulator and returns the number of fixed steps to run.
+u32 frame_scheduler_update(FrameScheduler* scheduler, f64 delta_time);
+
+// Waits until the next frame should start according to the target frame rate.
+void frame_scheduler_wait(FrameScheduler* scheduler);
+
+// Returns milliseconds until the accumulator reaches the next fixed step, rounded up.
+u32 frame_scheduler_time_to_step(FrameScheduler* scheduler);
+
+// Restarts frame pacing after the shell was waiting for events, the time spent
+// waiting is dropped and the next update runs one step right away.
+void frame_scheduler_wake(FrameScheduler* scheduler);
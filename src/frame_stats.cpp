@@ -0,0 +1,61 @@
+#include "frame_stats.hpp"
+#include <algorithm>
+
+void frame_stats_push(FrameStats* stats, FrameStatsSample const& sample) {
+    stats->samples[stats->frames_total % FRAME_STATS_WINDOW] = sample;
+    stats->frames_total += 1;
+
+    if (stats->samples_count < FRAME_STATS_WINDOW) {
+        stats->samples_count += 1;
+    }
+}
+
+// NOTE: Nearest-rank percentile, frame_times gets partially sorted
+static f64 frame_stats_percentile(f64* frame_times, u64 count, f64 percentile) {
+    u64 rank = (u64) (percentile * (f64) count + 0.5);
+    rank = rank > 0 ? rank - 1 : 0;
+    rank = rank < count ? rank : count - 1;
+
+    std::nth_element(frame_times, frame_times + rank, frame_times + count);
+    return frame_times[rank];
+}
+
+FrameStatsSummary frame_stats_summarize(FrameStats const* stats) {
+    FrameStatsSummary summary = {};
+    const u64 count = stats->samples_count;
+
+    if (count == 0) {
+        return summary;
+    }
+
+    f64 frame_times[FRAME_STATS_WINDOW];
+
+    for (u64 i = 0; i < count; i += 1) {
+        FrameStatsSample const& sample = stats->samples[i];
+
+        frame_times[i] = sample.frame_time;
+        summary.frame_time_average += sample.frame_time;
+        summary.frame_time_max = std::max(summary.frame_time_max, sample.frame_time);
+        summary.draw_calls_average += sample.draw_calls;
+        summary.instances_average += sample.instances;
+        summary.vertices_average += sample.vertices;
+        summary.uploaded_bytes_average += sample.uploaded_bytes;
+        summary.command_bytes_average += sample.command_bytes;
+        summary.texture_uploads += sample.texture_uploads;
+        summary.texture_upload_bytes += sample.texture_upload_bytes;
+    }
+
+    summary.frames = count;
+    summary.frame_time_average /= count;
+    summary.draw_calls_average /= count;
+    summary.instances_average /= count;
+    summary.vertices_average /= count;
+    summary.uploaded_bytes_average /= count;
+    summary.command_bytes_average /= count;
+
+    summary.frame_time_p50 = frame_stats_percentile(&frame_times[0], count, 0.50);
+    summary.frame_time_p95 = frame_stats_percentile(&frame_times[0], count, 0.95);
+    summary.frame_time_p99 = frame_stats_percentile(&frame_times[0], count, 0.99);
+
+    return summary;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "primitives.hpp"
+
+// Number of last rendered frames statistics are calculated over.
+static const size_t FRAME_STATS_WINDOW = 256;
+
+struct FrameStatsSample {
+    f64 frame_time;
+    u64 draw_calls;
+    u64 instances;
+    u64 vertices;
+    u64 uploaded_bytes;
+    u64 texture_uploads;
+    u64 texture_upload_bytes;
+    u64 command_bytes;
+};
+
+struct FrameStats {
+    FrameStatsSample samples[FRAME_STATS_WINDOW];
+    u64 samples_count;
+    u64 frames_total;
+};
+
+// Statistics over the window, times are in milliseconds.
+struct FrameStatsSummary {
+    u64 frames;
+    f64 frame_time_average;
+    f64 frame_time_p50;
+    f64 frame_time_p95;
+    f64 frame_time_p99;
+    f64 frame_time_max;
+    f64 draw_calls_average;
+    f64 instances_average;
+    f64 vertices_average;
+    f64 uploaded_bytes_average;
+    f64 command_bytes_average;
+    u64 texture_uploads;
+    u64 texture_upload_bytes;
+};
+
+void frame_stats_push(FrameStats* stats, FrameStatsSample const& sample);
+
+FrameStatsSummary frame_stats_summarize(FrameStats const* stats);
@@ -5,11 +5,43 @@
 #include "shell_memory.hpp"
 #include "assets.hpp"
 #include "shell_config.hpp"
+#include "gapi/command_table.hpp"
+
+// Size of the backend memory when ShellConfig doesn't set it
+static const u64 GAPI_MEMORY_DEFAULT = megabytes(10);
 
 struct GApi;
 
 struct GApiContext;
 
+struct GApiFrameStats {
+    u64 commands;
+    u64 batches;
+    u64 draw_calls;
+    u64 instances;
+    u64 vertices;
+    u64 state_changes;
+    u64 state_changes_elided;
+    // Bytes of instances and vertices uploaded to the stream buffers
+    u64 uploaded_bytes;
+    u64 texture_uploads;
+    u64 texture_upload_bytes;
+    // Bytes of the VM commands buffer decoded
+    u64 command_bytes;
+    // Commands without registered handler
+    u64 commands_skipped;
+    u64 memory_high_water;
+};
+
+struct GApiCommandGpuTime {
+    u64 command_id;
+    // Number of frames where the command had GPU work
+    u64 frames;
+    f64 average_ms;
+    f64 max_ms;
+    f64 last_frame_ms;
+};
+
 #ifdef GAPI_OPENGL
 
 #include "gapi/opengl.hpp"
@@ -22,6 +54,12 @@ struct GApiContext;
 
 #endif
 
+#ifdef GAPI_NULL
+
+#include "gapi/null.hpp"
+
+#endif
+
 struct Texture2D;
 
 struct Texture2DParameters {
@@ -31,20 +69,68 @@ struct Texture2DParameters {
     bool mag_filter;
 };
 
-Result<GApi> gapi_init(ShellConfig const& config);
+// Shaders and fonts are loaded into assets_memory, it should outlive the GAPI.
+Result<GApi> gapi_init(ShellConfig const& config, GrowableRegionMemoryBuffer* assets_memory);
 
 Result<GApiContext> gapi_create_context(Platform& platform, Window window);
 
 void gapi_swap_window(Platform& platform, Window window);
 
+// Reads RGBA pixels of the rendered frame top to bottom, should be called before swap.
+Result<bool> gapi_read_frame(Window& window, u8* dest, size_t size);
+
 void gapi_shutdown(GApiContext context);
 
 void gapi_clear(float r, float g, float b);
 
+// Renders the VM commands buffer.
 void gapi_render(GApi& gapi);
 
-Texture2D gapi_create_texture_2d(AssetData data, Texture2DParameters params);
+// Renders commands from any buffer with the VM commands buffer layout, e.g. recorded ones.
+void gapi_render_buffer(GApi& gapi, u8* base, u64 size);
+
+// Memory of the backend resources, e.g. stream staging and glyph atlas.
+MemoryUsage gapi_get_memory_usage(GApi& gapi);
+
+// Stats of the last rendered frame, texture uploads include the ones done between frames.
+GApiFrameStats gapi_get_frame_stats(GApi& gapi);
+
+// Returns true once after the client has sent COMMAND_STATE_REQUEST_FRAME_STATS.
+bool gapi_consume_frame_stats_request(GApi& gapi);
+
+// GPU times are a few frames behind, since they are read back without waiting for the GPU.
+size_t gapi_get_command_gpu_times(GApi& gapi, GApiCommandGpuTime* times, size_t capacity);
+
+f64 gapi_get_gpu_frame_time(GApi& gapi);
+
+void gapi_reset_command_gpu_times(GApi& gapi);
+
+Texture2D gapi_create_texture_2d(GApi& gapi, AssetData data, Texture2DParameters params);
+
+// Creates texture without pixels, they are uploaded with gapi_upload_texture_2d_rows.
+Texture2D gapi_create_empty_texture_2d(GApi& gapi, TextureHeader header, Texture2DParameters params);
+
+// Uploads tightly packed rows of pixels in the format of the header, starting from first_row.
+void gapi_upload_texture_2d_rows(GApi& gapi, Texture2D texture, TextureHeader header, u32 first_row, u32 rows_count, u8 const* data);
+
+void gapi_delete_texture_2d(GApi& gapi, Texture2D texture);
+
+void gapi_set_viewport(GApi& gapi, int x, int y, int width, int height);
+
+void collect_text_bounds(GApi& gapi);
+
+// Registers handler for the command id, replaces the built-in one if there is any.
+// Returns false if the id is out of the command table range.
+bool gapi_register_command_handler(GApi& gapi, u64 command_id, CommandHandler handler);
+
+// Registers handler of a command that should run once per commands buffer the VM produces,
+// like requests and asset loads. It is run by gapi_process_buffer_commands and skipped
+// by gapi_render_buffer, which runs again on the same buffer for every redraw.
+bool gapi_register_buffer_command_handler(GApi& gapi, u64 command_id, CommandHandler handler);
 
-void gapi_delete_texture_2d(Texture2D texture);
+// Runs buffer command handlers, should be called once for every new commands buffer.
+void gapi_process_buffer_commands(GApi& gapi, u8* base, u64 size);
 
-void gapi_set_viewport(int x, int y, int width, int height);
+// Transient data of the frame is allocated from the allocator, it should be reset
+// before every frame. Without allocator such data is not kept between commands.
+void gapi_set_frame_allocator(GApi& gapi, FrameAllocator* allocator);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "vm_buffers.hpp"
+
+struct GApi;
+struct CommandReader;
+
+// Handler gets reader limited to the payload of the command, so it can't
+// affect the position of the next command.
+typedef void (*CommandHandler)(GApi& gapi, CommandReader* reader);
+
+// NOTE: Command ids are (group << 16) | index, see vm.hpp
+static const u64 COMMAND_TABLE_GROUPS = 16;
+static const u64 COMMAND_TABLE_GROUP_SIZE = 64;
+
+struct CommandTable {
+    CommandHandler handlers[COMMAND_TABLE_GROUPS * COMMAND_TABLE_GROUP_SIZE];
+};
+
+static inline bool command_table_get_slot(u64 command_id, u64* slot) {
+    const u64 group = command_id >> 16;
+    const u64 index = command_id & 0xFFFF;
+
+    if (group >= COMMAND_TABLE_GROUPS || index >= COMMAND_TABLE_GROUP_SIZE) {
+        return false;
+    }
+
+    *slot = group * COMMAND_TABLE_GROUP_SIZE + index;
+    return true;
+}
+
+// Returns false if command id doesn't fit into the table.
+static inline bool command_table_register(CommandTable* table, u64 command_id, CommandHandler handler) {
+    u64 slot;
+
+    if (!command_table_get_slot(command_id, &slot)) {
+        return false;
+    }
+
+    table->handlers[slot] = handler;
+    return true;
+}
+
+// Returns nullptr for unsupported commands.
+static inline CommandHandler command_table_get(CommandTable const* table, u64 command_id) {
+    u64 slot;
+
+    if (!command_table_get_slot(command_id, &slot)) {
+        return nullptr;
+    }
+
+    return table->handlers[slot];
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "vm.hpp"
+#include "vm_math.hpp"
+#include "vm_buffers.hpp"
+#include "gapi/command_table.hpp"
+
+// Decoding helpers shared by GAPI backends.
+
+static const size_t GAPI_ADDRESS_CAPACITY = 256;
+
+// NOTE: The commands buffer is little-endian like all supported targets, so values
+// and arrays are loaded straight from the buffer instead of float by float.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Commands decoding expects little-endian target");
+static_assert(sizeof(Vec2f) == sizeof(f32) * 2, "Vec2f should be tightly packed");
+static_assert(sizeof(Vec3f) == sizeof(f32) * 3, "Vec3f should be tightly packed");
+static_assert(sizeof(Vec4f) == sizeof(f32) * 4, "Vec4f should be tightly packed");
+static_assert(sizeof(Mat4f) == sizeof(f32) * 16, "Mat4f should be tightly packed");
+
+// Reader of a command payload, reads are checked against the end of the payload.
+struct CommandReader {
+    BytesReader bytes_reader;
+    u8 const* end;
+};
+
+static inline CommandReader create_command_reader(u8 const* payload, u64 size) {
+    return CommandReader {
+        .bytes_reader = vm_buffers_create_bytes_reader(ByteOrder::LittleEndian, (u8*) payload, (size_t) size),
+        .end = payload + size,
+    };
+}
+
+// Returns pointer to `count` elements in the buffer and moves the reader past them,
+// nullptr if they don't fit into the rest of the payload, the reader isn't moved then.
+// NOTE: Elements may be unaligned, use load_* functions to read them.
+static inline u8 const* read_array(CommandReader* reader, u64 count, size_t element_size) {
+    // NOTE: Reading zero bytes returns the current position without moving the reader
+    u8 const* data = vm_buffers_bytes_reader_read_bytes_buffer(&reader->bytes_reader, 0);
+
+    if (data > reader->end) {
+        return nullptr;
+    }
+
+    const u64 remaining = (u64) (reader->end - data);
+
+    if (element_size == 0 || count > remaining / element_size) {
+        return nullptr;
+    }
+
+    return vm_buffers_bytes_reader_read_bytes_buffer(&reader->bytes_reader, (size_t) (count * element_size));
+}
+
+static inline Vec2f load_vec2f(u8 const* data) {
+    Vec2f result;
+    memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+static inline Mat4f load_mat4f(u8 const* data) {
+    Mat4f result;
+    memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+// NOTE: Values that don't fit into the payload are read as zeros
+
+static inline i32 read_int32(CommandReader* reader) {
+    i32 result = 0;
+    u8 const* data = read_array(reader, 1, sizeof(result));
+
+    if (data != nullptr) {
+        memcpy(&result, data, sizeof(result));
+    }
+
+    return result;
+}
+
+static inline i64 read_int64(CommandReader* reader) {
+    i64 result = 0;
+    u8 const* data = read_array(reader, 1, sizeof(result));
+
+    if (data != nullptr) {
+        memcpy(&result, data, sizeof(result));
+    }
+
+    return result;
+}
+
+static inline Vec2f read_vec2f(CommandReader* reader) {
+    u8 const* data = read_array(reader, 1, sizeof(Vec2f));
+    return data != nullptr ? load_vec2f(data) : Vec2f {};
+}
+
+static inline Vec3f read_vec3f(CommandReader* reader) {
+    Vec3f result = {};
+    u8 const* data = read_array(reader, 1, sizeof(Vec3f));
+
+    if (data != nullptr) {
+        memcpy(&result, data, sizeof(result));
+    }
+
+    return result;
+}
+
+static inline Vec4f read_vec4f(CommandReader* reader) {
+    Vec4f result = {};
+    u8 const* data = read_array(reader, 1, sizeof(Vec4f));
+
+    if (data != nullptr) {
+        memcpy(&result, data, sizeof(result));
+    }
+
+    return result;
+}
+
+static inline Mat4f read_mat4f(CommandReader* reader) {
+    u8 const* data = read_array(reader, 1, sizeof(Mat4f));
+    return data != nullptr ? load_mat4f(data) : Mat4f {};
+}
+
+static inline void copy_address(char* dest, u8 const* buffer, u64 len) {
+    const u64 copy_len = len < GAPI_ADDRESS_CAPACITY ? len : GAPI_ADDRESS_CAPACITY - 1;
+
+    memcpy(dest, buffer, (size_t) copy_len);
+    dest[copy_len] = '\0';
+}
+
+// Reads length prefixed address into dest of GAPI_ADDRESS_CAPACITY, returns its length,
+// 0 if it doesn't fit into the payload.
+static inline u64 read_address(CommandReader* reader, char* dest) {
+    const auto len = (u64) read_int64(reader);
+    const auto buffer = read_array(reader, len, 1);
+
+    if (buffer == nullptr) {
+        dest[0] = '\0';
+        return 0;
+    }
+
+    copy_address(dest, buffer, len);
+    return len;
+}
+
+struct CommandHeader {
+    u64 id;
+    u64 size;
+    u8 const* payload;
+};
+
+// Walks command headers of the commands buffer, every header is checked
+// against the buffer size before its payload is handed out.
+struct CommandsReader {
+    u8 const* base;
+    u64 size;
+    u64 offset;
+    u64 count;
+    u64 index;
+    bool malformed;
+};
+
+static inline u64 load_u64(u8 const* data) {
+    u64 result;
+    memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+// Reads the header of the commands buffer and the from address into dest of
+// GAPI_ADDRESS_CAPACITY, returns the address length, 0 if there is nothing to render.
+static inline u64 commands_reader_init(CommandsReader* reader, u8 const* base, u64 size, char* from_address) {
+    *reader = {
+        .base = base,
+        .size = size,
+        .offset = 0,
+        .count = 0,
+        .index = 0,
+        .malformed = false,
+    };
+
+    from_address[0] = '\0';
+
+    if (size < sizeof(u64) * 2) {
+        reader->malformed = true;
+        return 0;
+    }
+
+    const u64 count = load_u64(base);
+    const u64 address_len = load_u64(base + sizeof(u64));
+
+    if (address_len > size - sizeof(u64) * 2) {
+        reader->malformed = true;
+        return 0;
+    }
+
+    copy_address(from_address, base + sizeof(u64) * 2, address_len);
+
+    reader->count = count;
+    reader->offset = sizeof(u64) * 2 + address_len;
+
+    return address_len;
+}
+
+// Returns false after the last command or when the next header doesn't fit
+// into the buffer, the rest of the buffer is ignored in that case.
+static inline bool commands_reader_next(CommandsReader* reader, CommandHeader* header) {
+    if (reader->index >= reader->count) {
+        return false;
+    }
+
+    const u64 remaining = reader->size - reader->offset;
+
+    if (remaining < sizeof(u64) * 2) {
+        reader->malformed = true;
+        return false;
+    }
+
+    const u64 id = load_u64(reader->base + reader->offset);
+    const u64 skip = load_u64(reader->base + reader->offset + sizeof(u64));
+
+    if (skip > remaining - sizeof(u64) * 2) {
+        reader->malformed = true;
+        return false;
+    }
+
+    header->id = id;
+    header->size = skip;
+    header->payload = reader->base + reader->offset + sizeof(u64) * 2;
+
+    reader->offset += sizeof(u64) * 2 + skip;
+    reader->index += 1;
+
+    return true;
+}
+
+// Returns the number of bytes used by commands at the beginning of the commands buffer.
+static inline u64 get_commands_buffer_length(u8 const* base, u64 size) {
+    CommandsReader reader;
+    CommandHeader header;
+    char from_address[GAPI_ADDRESS_CAPACITY];
+
+    // NOTE: Commands without address are not rendered
+    if (commands_reader_init(&reader, base, size, &from_address[0]) != 0) {
+        while (commands_reader_next(&reader, &header)) {
+        }
+    }
+
+    return reader.offset;
+}
+
+// Runs handler of the command on a reader limited to its payload,
+// returns false for unsupported commands.
+static inline bool dispatch_command(GApi& gapi, CommandTable const* table, CommandHeader const& command) {
+    const CommandHandler handler = command_table_get(table, command.id);
+
+    if (handler == nullptr) {
+        return false;
+    }
+
+    auto reader = create_command_reader(command.payload, command.size);
+    handler(gapi, &reader);
+
+    return true;
+}
+
+// Runs handlers of the buffer commands of the commands buffer, other commands are ignored.
+static inline void dispatch_buffer_commands(GApi& gapi, CommandTable const* table, u8 const* base, u64 size) {
+    CommandsReader reader;
+    CommandHeader command;
+    char from_address[GAPI_ADDRESS_CAPACITY];
+
+    if (commands_reader_init(&reader, base, size, &from_address[0]) == 0) {
+        return;
+    }
+
+    while (commands_reader_next(&reader, &command)) {
+        dispatch_command(gapi, table, command);
+    }
+}
+
+static inline void push_text_boundary(char const* to, float w, float h) {
+    const auto bytes_writer = tech_paws_begin_command(to, Source::Processor, COMMAND_ADD_TEXT_BOUNDARIES);
+
+    vm_buffers_bytes_writer_write_float(bytes_writer, w);
+    vm_buffers_bytes_writer_write_float(bytes_writer, h);
+
+    tech_paws_end_command(to, Source::Processor);
+}
@@ -0,0 +1,289 @@
+#include "primitives.hpp"
+#include "gapi.hpp"
+#include "gapi/commands.hpp"
+#include "platform.hpp"
+#include "profiler.hpp"
+#include "assets.hpp"
+#include "vm.hpp"
+
+static void init_command_handlers(GApi& gapi);
+
+Result<GApi> gapi_init(ShellConfig const& config, GrowableRegionMemoryBuffer* assets_memory) {
+    GApi gapi = {};
+    gapi.config = config;
+    gapi.color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+    init_command_handlers(gapi);
+
+    return result_create_success(gapi);
+}
+
+Result<GApiContext> gapi_create_context(Platform& platform, Window window) {
+    return result_create_success(GApiContext());
+}
+
+void gapi_swap_window(Platform& platform, Window window) {
+}
+
+Result<bool> gapi_read_frame(Window& window, u8* dest, size_t size) {
+    return result_create_general_error<bool>(
+        ErrorCode::GApiReadFrame,
+        "Null backend doesn't render frames"
+    );
+}
+
+void gapi_shutdown(GApiContext context) {
+}
+
+void gapi_clear(float r, float g, float b) {
+}
+
+Texture2D gapi_create_texture_2d(GApi& gapi, const AssetData data, const Texture2DParameters params) {
+    TextureHeader texture_header = *((TextureHeader*) data.data);
+
+    gapi.textures_count += 1;
+
+    Texture2D texture;
+    texture.id = gapi.textures_count;
+    texture.width = texture_header.width;
+    texture.height = texture_header.height;
+
+    gapi.frame_stats.texture_uploads += 1;
+    gapi.frame_stats.texture_upload_bytes += data.size - sizeof(TextureHeader);
+
+    return texture;
+}
+
+Texture2D gapi_create_empty_texture_2d(GApi& gapi, TextureHeader header, Texture2DParameters params) {
+    gapi.textures_count += 1;
+
+    Texture2D texture;
+    texture.id = gapi.textures_count;
+    texture.width = header.width;
+    texture.height = header.height;
+
+    gapi.frame_stats.texture_uploads += 1;
+    return texture;
+}
+
+void gapi_upload_texture_2d_rows(GApi& gapi, Texture2D texture, TextureHeader header, u32 first_row, u32 rows_count, u8 const* data) {
+    gapi.frame_stats.texture_upload_bytes += (u64) texture.width * rows_count * texture_format_pixel_size(header.format);
+}
+
+void gapi_delete_texture_2d(GApi& gapi, Texture2D texture) {
+}
+
+static void gapi_set_color_pipeline(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+    gapi.color = read_vec4f(reader);
+}
+
+static void gapi_set_texture_pipeline(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+    read_int64(reader);
+    gapi.color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+}
+
+// Copies `count` elements into the sink, returns false if they don't fit into the payload.
+static bool gapi_decode_array(GApi& gapi, CommandReader* reader, u64 count, size_t element_size) {
+    u8 const* data = read_array(reader, count, element_size);
+
+    if (data == nullptr) {
+        return false;
+    }
+
+    const u64 size = count * element_size;
+
+    for (u64 offset = 0; offset < size; offset += GAPI_NULL_SINK_SIZE) {
+        const u64 chunk_size = size - offset < GAPI_NULL_SINK_SIZE ? size - offset : GAPI_NULL_SINK_SIZE;
+        memcpy(&gapi.sink[0], data + offset, (size_t) chunk_size);
+    }
+
+    return true;
+}
+
+static void gapi_draw_quad_instances(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+    auto const count = (u64) read_int64(reader);
+
+    if (!gapi_decode_array(gapi, reader, count, sizeof(Mat4f))) {
+        return;
+    }
+
+    gapi.frame_stats.draw_calls += 1;
+    gapi.frame_stats.instances += count;
+    gapi.frame_stats.uploaded_bytes += count * (sizeof(Mat4f) + sizeof(Vec4f) * 2);
+}
+
+static void gapi_draw_lines(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+    read_mat4f(reader);
+    auto const count = (u64) read_int64(reader);
+
+    if (!gapi_decode_array(gapi, reader, count, sizeof(Vec2f))) {
+        return;
+    }
+
+    gapi.frame_stats.draw_calls += 1;
+    gapi.frame_stats.vertices += count;
+    gapi.frame_stats.uploaded_bytes += count * sizeof(Vec4f) * 2;
+}
+
+static void gapi_draw_texts(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+
+    char from_addr[GAPI_ADDRESS_CAPACITY];
+    const u64 from_addr_len = read_address(reader, &from_addr[0]);
+
+    if (from_addr_len == 0) {
+        return;
+    }
+
+    auto const count = (u64) read_int64(reader);
+
+    for (u64 i = 0; i < count; i += 1) {
+        read_int64(reader);
+        const auto font_size = (u32) read_int32(reader);
+        read_mat4f(reader);
+
+        const auto str_len = (u64) read_int64(reader);
+        if (read_array(reader, str_len, 1) == nullptr) {
+            return;
+        }
+
+        if (str_len == 0) {
+            continue;
+        }
+
+        // NOTE: There are no fonts, layout in the VM still needs some boundaries,
+        // so every glyph is considered half of the font size wide.
+        push_text_boundary(&from_addr[0], str_len * font_size / 2, font_size);
+
+        gapi.frame_stats.draw_calls += 1;
+        gapi.frame_stats.instances += str_len;
+    }
+}
+
+static void gapi_set_viewport(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+
+    gapi.viewport[0] = read_int32(reader);
+    gapi.viewport[1] = read_int32(reader);
+    gapi.viewport[2] = read_int32(reader);
+    gapi.viewport[3] = read_int32(reader);
+}
+
+void gapi_render(GApi& gapi) {
+    const auto commands_buffer = tech_paws_vm_get_commands_buffer();
+    gapi_render_buffer(gapi, commands_buffer.base, commands_buffer.size);
+}
+
+static void gapi_request_frame_stats(GApi& gapi, CommandReader* reader) {
+    gapi.frame_stats_requested = true;
+}
+
+static void init_command_handlers(GApi& gapi) {
+    CommandTable* table = &gapi.commands;
+
+    command_table_register(table, COMMAND_GAPI_SET_COLOR_PIPELINE, gapi_set_color_pipeline);
+    command_table_register(table, COMMAND_GAPI_SET_TEXTURE_PIPELINE, gapi_set_texture_pipeline);
+    command_table_register(table, COMMAND_GAPI_DRAW_CENTERED_QUADS, gapi_draw_quad_instances);
+    command_table_register(table, COMMAND_GAPI_DRAW_QUADS, gapi_draw_quad_instances);
+    command_table_register(table, COMMAND_GAPI_DRAW_LINES, gapi_draw_lines);
+    command_table_register(table, COMMAND_GAPI_DRAW_PATH, gapi_draw_lines);
+    command_table_register(table, COMMAND_GAPI_DRAW_TEXTS, gapi_draw_texts);
+    command_table_register(table, COMMAND_GAPI_SET_VIEWPORT, gapi_set_viewport);
+
+    // NOTE: Every request gets one reply, so it isn't handled again on redraws
+    command_table_register(&gapi.buffer_commands, COMMAND_STATE_REQUEST_FRAME_STATS, gapi_request_frame_stats);
+}
+
+bool gapi_register_command_handler(GApi& gapi, u64 command_id, CommandHandler handler) {
+    return command_table_register(&gapi.commands, command_id, handler);
+}
+
+bool gapi_register_buffer_command_handler(GApi& gapi, u64 command_id, CommandHandler handler) {
+    return command_table_register(&gapi.buffer_commands, command_id, handler);
+}
+
+void gapi_process_buffer_commands(GApi& gapi, u8* base, u64 size) {
+    PROFILE_FUNCTION();
+    dispatch_buffer_commands(gapi, &gapi.buffer_commands, base, size);
+}
+
+void gapi_set_frame_allocator(GApi& gapi, FrameAllocator* allocator) {
+    gapi.frame_allocator = allocator;
+}
+
+void gapi_render_buffer(GApi& gapi, u8* base, u64 size) {
+    PROFILE_FUNCTION();
+
+    CommandsReader commands_reader;
+    char from_address[GAPI_ADDRESS_CAPACITY];
+    const u64 str_len = commands_reader_init(&commands_reader, base, size, &from_address[0]);
+
+    if (str_len == 0) {
+        return;
+    }
+
+    gapi.frame_stats.command_bytes += sizeof(u64) * 2 + str_len;
+    gapi.color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+
+    CommandHeader command;
+
+    while (commands_reader_next(&commands_reader, &command)) {
+        gapi.frame_stats.commands += 1;
+        gapi.frame_stats.command_bytes += sizeof(u64) * 2 + command.size;
+
+        // NOTE: Buffer commands have already been handled by gapi_process_buffer_commands
+        if (!dispatch_command(gapi, &gapi.commands, command) && command_table_get(&gapi.buffer_commands, command.id) == nullptr) {
+            gapi.frame_stats.commands_skipped += 1;
+        }
+    }
+
+    if (commands_reader.malformed) {
+        log_error(
+            "Malformed commands buffer, rendered %llu of %llu commands",
+            (unsigned long long) commands_reader.index,
+            (unsigned long long) commands_reader.count
+        );
+    }
+
+    gapi.frame_stats.batches = gapi.frame_stats.draw_calls;
+    gapi.last_frame_stats = gapi.frame_stats;
+    gapi.frame_stats = {};
+}
+
+MemoryUsage gapi_get_memory_usage(GApi& gapi) {
+    return {};
+}
+
+GApiFrameStats gapi_get_frame_stats(GApi& gapi) {
+    return gapi.last_frame_stats;
+}
+
+bool gapi_consume_frame_stats_request(GApi& gapi) {
+    const bool requested = gapi.frame_stats_requested;
+    gapi.frame_stats_requested = false;
+    return requested;
+}
+
+size_t gapi_get_command_gpu_times(GApi& gapi, GApiCommandGpuTime* times, size_t capacity) {
+    return 0;
+}
+
+f64 gapi_get_gpu_frame_time(GApi& gapi) {
+    return 0.0;
+}
+
+void gapi_reset_command_gpu_times(GApi& gapi) {
+}
+
+void collect_text_bounds(GApi& gapi) {
+}
+
+void gapi_set_viewport(GApi& gapi, int x, int y, int width, int height) {
+    gapi.viewport[0] = x;
+    gapi.viewport[1] = y;
+    gapi.viewport[2] = width;
+    gapi.viewport[3] = height;
+}
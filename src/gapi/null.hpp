@@ -0,0 +1,44 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "shell_config.hpp"
+#include "vm_math.hpp"
+#include "gapi/command_table.hpp"
+#include "frame_allocator.hpp"
+
+// Backend that decodes commands without rendering, used to measure
+// the command decoding and the VM in isolation.
+
+// Decoded arrays are copied into the sink by chunks of this size
+static const u64 GAPI_NULL_SINK_SIZE = kilobytes(16);
+
+struct GApiContext {
+};
+
+struct Texture2D {
+    u32 id = 0;
+    u32 width;
+    u32 height;
+};
+
+struct GApi {
+    ShellConfig config;
+
+    u32 textures_count;
+    Vec4f color;
+    int viewport[4];
+
+    CommandTable commands;
+    // Commands handled once per commands buffer, see gapi_process_buffer_commands
+    CommandTable buffer_commands;
+    // Not used, nothing is kept between commands
+    FrameAllocator* frame_allocator;
+
+    GApiFrameStats frame_stats;
+    GApiFrameStats last_frame_stats;
+    bool frame_stats_requested;
+
+    // NOTE: Elements are copied like a real backend copies them into its buffers,
+    // so the decoding cost is still measured
+    u8 sink[GAPI_NULL_SINK_SIZE];
+};
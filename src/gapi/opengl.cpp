@@ -1,6 +1,14 @@
 #include "primitives.hpp"
 #include "gapi/opengl.hpp"
+#include "gapi/opengl_glyph_atlas.hpp"
+#include "gapi/opengl_stream_buffer.hpp"
+#include "gapi/commands.hpp"
+#include "gapi/opengl_prepare.hpp"
 #include "platform.hpp"
+#include "profiler.hpp"
+#include "memory_tracking.hpp"
+#include "jobs.hpp"
+#include "texture_registry.hpp"
 #include "assets.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -186,6 +194,51 @@ static void gapi_create_vector2f_vao(GLuint buffer, u32 location) {
     glVertexAttribPointer(location, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 }
 
+static void gapi_create_instance_vao(GLuint buffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    for (u32 i = 0; i < 4; i += 1) {
+        const u32 location = GAPI_ATTRIBUTE_INSTANCE_MVP + i;
+        const size_t offset = offsetof(QuadInstance, mvp) + sizeof(f32) * 4 * i;
+
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*) offset);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    const size_t tex_rect_offset = offsetof(QuadInstance, tex_rect);
+
+    glEnableVertexAttribArray(GAPI_ATTRIBUTE_INSTANCE_TEX_RECT);
+    glVertexAttribPointer(GAPI_ATTRIBUTE_INSTANCE_TEX_RECT, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*) tex_rect_offset);
+    glVertexAttribDivisor(GAPI_ATTRIBUTE_INSTANCE_TEX_RECT, 1);
+
+    const size_t color_offset = offsetof(QuadInstance, color);
+
+    glEnableVertexAttribArray(GAPI_ATTRIBUTE_COLOR);
+    glVertexAttribPointer(GAPI_ATTRIBUTE_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*) color_offset);
+    glVertexAttribDivisor(GAPI_ATTRIBUTE_COLOR, 1);
+}
+
+static Result<bool> init_instances(GApi& gapi) {
+    static_assert(sizeof(Mat4f) == sizeof(f32) * 16, "Mat4f should be tightly packed");
+    static_assert(sizeof(Vec4f) == sizeof(f32) * 4, "Vec4f should be tightly packed");
+
+    MEMORY_TAG("gapi/instances_stream");
+    return stream_buffer_init(&gapi.instances_stream, &gapi.memory, sizeof(QuadInstance) * GAPI_INSTANCES_CAPACITY);
+}
+
+// NOTE: Instances are written directly into the stream buffer memory,
+// which is mapped GPU memory when persistent mapping is supported.
+static void gapi_restart_instances(GApi& gapi) {
+    stream_buffer_restart_frame(&gapi.instances_stream);
+    gapi.instances_count = 0;
+}
+
+static void gapi_upload_instances(GApi& gapi, u32 first, u64 count) {
+    gapi.frame_stats.uploaded_bytes += sizeof(QuadInstance) * count;
+    stream_buffer_flush(&gapi.instances_stream, &gapi.gl_state, sizeof(QuadInstance) * first, sizeof(QuadInstance) * count);
+}
+
 static void init_centered_quad(GApi& gapi) {
     create_buffer(&gapi.quad_indices_buffer, &quad_indices[0], sizeof(u32) * quad_indices_count, false);
     create_buffer(&gapi.quad_vertices_buffer, &quad_vertices[0], sizeof(f32) * 2 * quad_vertices_count, false);
@@ -193,8 +246,10 @@ static void init_centered_quad(GApi& gapi) {
     glGenVertexArrays(1, &gapi.quad_vao);
 
     glBindVertexArray(gapi.quad_vao);
-    gapi_create_vector2f_vao(gapi.quad_vertices_buffer, 0);
-    gapi_create_vector2f_vao(gapi.quad_tex_coords_buffer, 1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.quad_indices_buffer);
+    gapi_create_vector2f_vao(gapi.quad_vertices_buffer, GAPI_ATTRIBUTE_POSITION);
+    gapi_create_vector2f_vao(gapi.quad_tex_coords_buffer, GAPI_ATTRIBUTE_TEX_COORD);
+    gapi_create_instance_vao(gapi.instances_stream.id);
 }
 
 static void init_quad(GApi& gapi) {
@@ -204,26 +259,68 @@ static void init_quad(GApi& gapi) {
     glGenVertexArrays(1, &gapi.centered_quad_vao);
 
     glBindVertexArray(gapi.centered_quad_vao);
-    gapi_create_vector2f_vao(gapi.centered_quad_vertices_buffer, 0);
-    gapi_create_vector2f_vao(gapi.centered_quad_tex_coords_buffer, 1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.centered_quad_indices_buffer);
+    gapi_create_vector2f_vao(gapi.centered_quad_vertices_buffer, GAPI_ATTRIBUTE_POSITION);
+    gapi_create_vector2f_vao(gapi.centered_quad_tex_coords_buffer, GAPI_ATTRIBUTE_TEX_COORD);
+    gapi_create_instance_vao(gapi.instances_stream.id);
 }
 
-static void init_lines(GApi& gapi) {
-    gapi.lines_vertices.reserve(100);
-    gapi.lines_indices.reserve(100);
+static Result<bool> init_lines(GApi& gapi) {
+    MEMORY_TAG("gapi/lines_stream");
+    const auto stream_result = stream_buffer_init(&gapi.lines_stream, &gapi.memory, sizeof(LineVertex) * GAPI_LINES_VERTICES_CAPACITY);
+
+    if (result_has_error(stream_result)) {
+        return stream_result;
+    }
 
-    create_buffer(&gapi.lines_indices_buffer, &gapi.lines_indices[0], 0, true);
-    create_buffer(&gapi.lines_vertices_buffer, &gapi.lines_vertices[0], 0, true);
     glGenVertexArrays(1, &gapi.lines_vao);
 
     glBindVertexArray(gapi.lines_vao);
-    gapi_create_vector2f_vao(gapi.lines_vertices_buffer, 0);
+    gapi_create_instance_vao(gapi.instances_stream.id);
+
+    // NOTE: Lines are transformed on CPU, so they can be merged into one draw call,
+    // the only instance is identity and the color comes per vertex.
+    const size_t position_offset = offsetof(LineVertex, position);
+    const size_t color_offset = offsetof(LineVertex, color);
+
+    glBindBuffer(GL_ARRAY_BUFFER, gapi.lines_stream.id);
+    glEnableVertexAttribArray(GAPI_ATTRIBUTE_POSITION);
+    glVertexAttribPointer(GAPI_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void*) position_offset);
+    glVertexAttribPointer(GAPI_ATTRIBUTE_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void*) color_offset);
+    glVertexAttribDivisor(GAPI_ATTRIBUTE_COLOR, 0);
+
+    return result_create_success(true);
+}
+
+static void gapi_restart_lines(GApi& gapi) {
+    stream_buffer_restart_frame(&gapi.lines_stream);
+    gapi.lines_vertices_count = 0;
+}
+
+static void gapi_upload_lines(GApi& gapi, u32 first, u64 count) {
+    gapi.frame_stats.uploaded_bytes += sizeof(LineVertex) * count;
+    stream_buffer_flush(&gapi.lines_stream, &gapi.gl_state, sizeof(LineVertex) * first, sizeof(LineVertex) * count);
+}
+
+static void gapi_begin_streams(GApi& gapi) {
+    stream_buffer_begin_frame(&gapi.instances_stream);
+    stream_buffer_begin_frame(&gapi.lines_stream);
+
+    gapi.instances = (QuadInstance*) stream_buffer_frame_data(&gapi.instances_stream);
+    gapi.instances_count = 0;
+    gapi.lines_vertices = (LineVertex*) stream_buffer_frame_data(&gapi.lines_stream);
+    gapi.lines_vertices_count = 0;
+}
+
+static void gapi_end_streams(GApi& gapi) {
+    stream_buffer_end_frame(&gapi.instances_stream);
+    stream_buffer_end_frame(&gapi.lines_stream);
 }
 
 static Result<bool> gapi_load_shader(GApi& gapi, size_t id, const char* name, const char* file_name, ShaderType type) {
     const Result<AssetData> shader_asset_result = asset_load_data(
         gapi.config,
-        &gapi.memory,
+        gapi.assets_memory,
         AssetType::shader,
         file_name
     );
@@ -246,7 +343,7 @@ static Result<bool> gapi_load_shader(GApi& gapi, size_t id, const char* name, co
 inline static Result<bool> init_debug_font(GApi& gapi) {
     const Result<AssetData> asset_result = asset_load_data(
         gapi.config,
-        &gapi.memory,
+        gapi.assets_memory,
         AssetType::font,
         "DejaVuSans.ttf"
     );
@@ -313,22 +410,7 @@ static Result<bool> init_color_shader_program(GApi& gapi) {
         return switch_error<bool>(program_result);
     }
 
-    auto program = result_get_payload(program_result);
-
-    Result<bool> location_result;
-    location_result = init_shader_uniform_location(gapi, GAPI_SHADER_LOCATION_COLOR_SHADER_MVP_ID, program, "MVP");
-
-    if (result_has_error(location_result)) {
-        return location_result;
-    }
-
-    location_result = init_shader_uniform_location(gapi, GAPI_SHADER_LOCATION_COLOR_SHADER_COLOR_ID, program, "color");
-
-    if (result_has_error(location_result)) {
-        return location_result;
-    }
-
-    gapi.shader_program_color = program;
+    gapi.shader_program_color = result_get_payload(program_result);
     return result_create_success(true);
 }
 
@@ -344,14 +426,7 @@ static Result<bool> init_texture_shader_program(GApi& gapi) {
 
     auto program = result_get_payload(program_result);
 
-    Result<bool> location_result;
-    location_result = init_shader_uniform_location(gapi, GAPI_SHADER_LOCATION_TEXTURE_SHADER_MVP_ID, program, "MVP");
-
-    if (result_has_error(location_result)) {
-        return location_result;
-    }
-
-    location_result = init_shader_uniform_location(gapi, GAPI_SHADER_LOCATION_TEXTURE_SHADER_TEXTURE_ID, program, "utexture");
+    const auto location_result = init_shader_uniform_location(gapi, GAPI_SHADER_LOCATION_TEXTURE_SHADER_TEXTURE_ID, program, "utexture");
 
     if (result_has_error(location_result)) {
         return location_result;
@@ -361,7 +436,9 @@ static Result<bool> init_texture_shader_program(GApi& gapi) {
     return result_create_success(true);
 }
 
-Result<GApi> gapi_init(ShellConfig const& config) {
+static void init_command_handlers(GApi& gapi);
+
+Result<GApi> gapi_init(ShellConfig const& config, GrowableRegionMemoryBuffer* assets_memory) {
     glDisable(GL_CULL_FACE);
     glDisable(GL_MULTISAMPLE);
     glDisable(GL_DEPTH_TEST);
@@ -370,19 +447,30 @@ Result<GApi> gapi_init(ShellConfig const& config) {
     glClearColor(0.f, 0.f, 0.f, 0.f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    auto buffer_result = create_region_memory_buffer(megabytes(10));
+    auto buffer_result = create_region_memory_buffer(memory_budget(config.gapi_memory_mb, GAPI_MEMORY_DEFAULT));
 
     if (result_is_success(buffer_result)) {
-        GApi gapi;
+        GApi gapi = {};
         gapi.config = config;
         gapi.memory = result_get_payload(buffer_result);
+        gapi.assets_memory = assets_memory;
 
         Result<bool> init_component_result;
 
         // Geometry
+        init_component_result = init_instances(gapi);
+
+        if (result_has_error(init_component_result)) {
+            return switch_error<GApi>(init_component_result);
+        }
+
         init_quad(gapi);
         init_centered_quad(gapi);
-        init_lines(gapi);
+        init_component_result = init_lines(gapi);
+
+        if (result_has_error(init_component_result)) {
+            return switch_error<GApi>(init_component_result);
+        }
 
         // Fonts
 
@@ -424,6 +512,12 @@ Result<GApi> gapi_init(ShellConfig const& config) {
             return switch_error<GApi>(init_component_result);
         }
 
+        init_command_handlers(gapi);
+
+        // NOTE: Initialization binds objects directly, so the cache starts from scratch
+        gl_state_reset(&gapi.gl_state);
+        gpu_timer_init(&gapi.gpu_timer);
+
         return result_create_success(gapi);
     } else {
         return switch_error<GApi>(buffer_result);
@@ -435,31 +529,38 @@ void gapi_clear(float r, float g, float b) {
     glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
-Texture2D gapi_create_texture_2d(const AssetData data, const Texture2DParameters params) {
-    Texture2D texture;
+static GLenum gapi_texture_format(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::rgb:
+            return GL_RGB;
+
+        case TextureFormat::rgba:
+            return GL_RGBA;
+    }
+
+    return GL_RGBA;
+}
+
+Texture2D gapi_create_texture_2d(GApi& gapi, const AssetData data, const Texture2DParameters params) {
     TextureHeader texture_header = *((TextureHeader*) data.data);
     u8* texture_data = data.data + sizeof(TextureHeader);
 
-    texture.width = texture_header.width;
-    texture.height = texture_header.height;
+    const Texture2D texture = gapi_create_empty_texture_2d(gapi, texture_header, params);
+    gapi_upload_texture_2d_rows(gapi, texture, texture_header, 0, texture_header.height, texture_data);
 
-    GLenum format;
+    return texture;
+}
 
-    switch (texture_header.format) {
-        case TextureFormat::rgb:
-            format = GL_RGB;
-            break;
+Texture2D gapi_create_empty_texture_2d(GApi& gapi, TextureHeader header, Texture2DParameters params) {
+    Texture2D texture;
+    texture.width = header.width;
+    texture.height = header.height;
 
-        case TextureFormat::rgba:
-            format = GL_RGBA;
-            break;
-    }
+    const GLenum format = gapi_texture_format(header.format);
 
     glGenTextures(1, &texture.id);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+    gl_state_bind_texture(&gapi.gl_state, GAPI_TEXTURE_UNIT_UPLOAD, texture.id);
 
-    // TODO: Not sure if I should use it
-    // glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexImage2D(
         /* target */ GL_TEXTURE_2D,
         /* level */ 0,
@@ -469,9 +570,11 @@ Texture2D gapi_create_texture_2d(const AssetData data, const Texture2DParameters
         /* border */ 0,
         /* format */ format,
         /* type */ GL_UNSIGNED_BYTE,
-        /* data */ texture_data
+        /* data */ nullptr
     );
 
+    gapi.frame_stats.texture_uploads += 1;
+
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -480,62 +583,213 @@ Texture2D gapi_create_texture_2d(const AssetData data, const Texture2DParameters
     return texture;
 }
 
-void gapi_delete_texture_2d(Texture2D texture) {
-    glDeleteTextures(1, &texture.id);
-}
+void gapi_upload_texture_2d_rows(GApi& gapi, Texture2D texture, TextureHeader header, u32 first_row, u32 rows_count, u8 const* data) {
+    gl_state_bind_texture(&gapi.gl_state, GAPI_TEXTURE_UNIT_UPLOAD, texture.id);
 
-static inline Vec2f read_vec2f(BytesReader* bytes_reader) {
-    return vm_vec2f(
-        vm_buffers_bytes_reader_read_float(bytes_reader),
-        vm_buffers_bytes_reader_read_float(bytes_reader)
+    // NOTE: Rows are tightly packed, while GL expects them aligned to 4 bytes by default
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+        /* target */ GL_TEXTURE_2D,
+        /* level */ 0,
+        /* xoffset */ 0,
+        /* yoffset */ first_row,
+        /* width */ texture.width,
+        /* height */ rows_count,
+        /* format */ gapi_texture_format(header.format),
+        /* type */ GL_UNSIGNED_BYTE,
+        /* data */ data
     );
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    gapi.frame_stats.texture_upload_bytes += (u64) texture.width * rows_count * texture_format_pixel_size(header.format);
 }
 
-static inline Vec3f read_vec3f(BytesReader* bytes_reader) {
-    return vm_vec3f(
-        vm_buffers_bytes_reader_read_float(bytes_reader),
-        vm_buffers_bytes_reader_read_float(bytes_reader),
-        vm_buffers_bytes_reader_read_float(bytes_reader)
-    );
+void gapi_delete_texture_2d(GApi& gapi, Texture2D texture) {
+    gl_state_delete_texture(&gapi.gl_state, texture.id);
 }
 
-static inline Vec4f read_vec4f(BytesReader* bytes_reader) {
-    return vm_vec4f(
-        vm_buffers_bytes_reader_read_float(bytes_reader),
-        vm_buffers_bytes_reader_read_float(bytes_reader),
-        vm_buffers_bytes_reader_read_float(bytes_reader),
-        vm_buffers_bytes_reader_read_float(bytes_reader)
-    );
+static bool batch_state_equals(BatchState const& a, BatchState const& b) {
+    return a.primitive == b.primitive &&
+        a.program == b.program &&
+        a.texture == b.texture;
 }
 
-static inline Mat4f read_mat4f(BytesReader* bytes_reader) {
-    return vm_mat4f(
-        read_vec4f(bytes_reader),
-        read_vec4f(bytes_reader),
-        read_vec4f(bytes_reader),
-        read_vec4f(bytes_reader)
-    );
+static void gapi_apply_batch_state(GApi& gapi, BatchState const& state) {
+    gl_state_use_program(&gapi.gl_state, state.program);
+
+    if (state.program == gapi.shader_program_texture.id) {
+        const auto loc = gapi.shader_uniform_locations[GAPI_SHADER_LOCATION_TEXTURE_SHADER_TEXTURE_ID];
+
+        gl_state_bind_texture(&gapi.gl_state, GAPI_TEXTURE_UNIT_DRAW, state.texture);
+        gl_state_uniform_1i(&gapi.gl_state, loc, GAPI_TEXTURE_UNIT_DRAW);
+    }
+
+    switch (state.primitive) {
+        case BatchPrimitive::quads:
+            gl_state_bind_vertex_array(&gapi.gl_state, gapi.quad_vao);
+            break;
+
+        case BatchPrimitive::centered_quads:
+            gl_state_bind_vertex_array(&gapi.gl_state, gapi.centered_quad_vao);
+            break;
+
+        case BatchPrimitive::lines:
+            gl_state_bind_vertex_array(&gapi.gl_state, gapi.lines_vao);
+            break;
+
+        case BatchPrimitive::none:
+            break;
+    }
 }
 
-static void gapi_set_color_pipeline(GApi& gapi, BytesReader* bytes_reader) {
+// Submits everything accumulated in the current batch with a single draw call.
+static void gapi_flush_batch(GApi& gapi) {
+    PROFILE_FUNCTION();
 
-#ifdef VALIDATE
-    glValidateProgram(gapi.shader_program_color.id);
-    const auto status_reault = check_program_status(gapi.shader_program_color, GL_VALIDATE_STATUS);
-    result_unwrap(status_reault);
-#endif
+    Batch& batch = gapi.batch;
 
-    glUseProgram(gapi.shader_program_color.id);
+    if (batch.instances_count == 0) {
+        return;
+    }
 
-    const auto color = read_vec4f(bytes_reader);
+    gapi_apply_batch_state(gapi, batch.state);
+    gapi_upload_instances(gapi, batch.first_instance, batch.instances_count);
+
+    // NOTE: Offsets in the stream buffers are relative to the current frame section
+    const u32 base_instance = stream_buffer_frame_offset(&gapi.instances_stream) / sizeof(QuadInstance) + batch.first_instance;
+
+    switch (batch.state.primitive) {
+        case BatchPrimitive::quads:
+        case BatchPrimitive::centered_quads:
+            gpu_timer_begin(&gapi.gpu_timer, batch.command_id);
+            glDrawElementsInstancedBaseInstance(
+                GL_TRIANGLE_STRIP,
+                quad_indices_count,
+                GL_UNSIGNED_INT,
+                nullptr,
+                batch.instances_count,
+                base_instance
+            );
+            gpu_timer_end(&gapi.gpu_timer);
+            gapi.frame_stats.draw_calls += 1;
+            break;
+
+        case BatchPrimitive::lines:
+            if (batch.vertices_count > 0) {
+                const u32 base_vertex = stream_buffer_frame_offset(&gapi.lines_stream) / sizeof(LineVertex) + batch.first_vertex;
+
+                gapi_upload_lines(gapi, batch.first_vertex, batch.vertices_count);
+                gpu_timer_begin(&gapi.gpu_timer, batch.command_id);
+                glDrawArraysInstancedBaseInstance(
+                    GL_LINES,
+                    base_vertex,
+                    batch.vertices_count,
+                    1,
+                    base_instance
+                );
+                gpu_timer_end(&gapi.gpu_timer);
+                gapi.frame_stats.draw_calls += 1;
+            }
+            break;
+
+        case BatchPrimitive::none:
+            break;
+    }
+
+    gapi.frame_stats.batches += 1;
+    gapi.frame_stats.instances += batch.instances_count;
+    gapi.frame_stats.vertices += batch.vertices_count;
+
+    batch.instances_count = 0;
+    batch.vertices_count = 0;
+}
+
+// Starts a new batch if the requested state differs from the current one,
+// otherwise the following draws are merged into the current batch.
+static void gapi_begin_batch(GApi& gapi, BatchPrimitive primitive, GLuint program, GLuint texture) {
+    const BatchState state = {
+        .primitive = primitive,
+        .program = program,
+        // NOTE: Texture doesn't matter for the color pipeline
+        .texture = program == gapi.shader_program_texture.id ? texture : 0,
+    };
+
+    if (!batch_state_equals(state, gapi.batch.state)) {
+        gapi_flush_batch(gapi);
+        gapi.batch.state = state;
+        gapi.batch.command_id = gapi.command_id;
+    }
+}
+
+// Returns a place for up to count instances in the current batch,
+// the number of instances that fit is written into pushed.
+static QuadInstance* gapi_batch_push_instances(GApi& gapi, u64 count, u64* pushed) {
+    Batch& batch = gapi.batch;
+
+    if (gapi.instances_count == GAPI_INSTANCES_CAPACITY) {
+        gapi_flush_batch(gapi);
+        gapi_restart_instances(gapi);
+    }
+
+    const u64 available = GAPI_INSTANCES_CAPACITY - gapi.instances_count;
+    const u32 instance = gapi.instances_count;
+
+    *pushed = count < available ? count : available;
+    gapi.instances_count += *pushed;
 
-    const auto loc = gapi.shader_uniform_locations[GAPI_SHADER_LOCATION_COLOR_SHADER_COLOR_ID];
-    gapi.mvp_uniform_location_id = GAPI_SHADER_LOCATION_COLOR_SHADER_MVP_ID;
+    if (batch.instances_count == 0) {
+        batch.first_instance = instance;
+    }
+
+    batch.instances_count += *pushed;
+    return &gapi.instances[instance];
+}
+
+static QuadInstance* gapi_batch_push_instance(GApi& gapi) {
+    u64 pushed;
+    return gapi_batch_push_instances(gapi, 1, &pushed);
+}
+
+// Returns a place for vertices of up to count line segments in the current batch,
+// the number of segments that fit is written into pushed.
+static LineVertex* gapi_batch_push_lines(GApi& gapi, u64 count, u64* pushed) {
+    Batch& batch = gapi.batch;
+
+    if (gapi.lines_vertices_count + 2 > GAPI_LINES_VERTICES_CAPACITY) {
+        gapi_flush_batch(gapi);
+        gapi_restart_lines(gapi);
+    }
+
+    if (batch.instances_count == 0) {
+        QuadInstance* instance = gapi_batch_push_instance(gapi);
+
+        instance->mvp = vm_mat4f(glm::mat4(1.0f));
+        instance->tex_rect = vm_vec4f(0.f, 0.f, 1.f, 1.f);
+        instance->color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+    }
+
+    const u64 available = (GAPI_LINES_VERTICES_CAPACITY - gapi.lines_vertices_count) / 2;
+    const u32 vertex = gapi.lines_vertices_count;
+
+    *pushed = count < available ? count : available;
+    gapi.lines_vertices_count += *pushed * 2;
+
+    if (batch.vertices_count == 0) {
+        batch.first_vertex = vertex;
+    }
+
+    batch.vertices_count += *pushed * 2;
+    return &gapi.lines_vertices[vertex];
+}
 
-    glUniform4fv(loc, 1, tech_paws_vm_math_vec4fptr(color));
+// Returns a place for two vertices of a line segment in the current batch.
+static LineVertex* gapi_batch_push_line(GApi& gapi) {
+    u64 pushed;
+    return gapi_batch_push_lines(gapi, 1, &pushed);
 }
 
-static void gapi_set_texture_pipeline(GApi& gapi, BytesReader* bytes_reader) {
+static void gapi_set_color_pipeline(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
 #ifdef VALIDATE
     glValidateProgram(gapi.shader_program_color.id);
@@ -543,307 +797,504 @@ static void gapi_set_texture_pipeline(GApi& gapi, BytesReader* bytes_reader) {
     result_unwrap(status_reault);
 #endif
 
-    glUseProgram(gapi.shader_program_texture.id);
+    gapi.pipeline.program = gapi.shader_program_color.id;
+    gapi.pipeline.texture = 0;
+    gapi.pipeline.color = read_vec4f(reader);
+}
+
+static void gapi_set_texture_pipeline(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
-    const auto textureId = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
-    const auto loc = gapi.shader_uniform_locations[GAPI_SHADER_LOCATION_TEXTURE_SHADER_TEXTURE_ID];
-    gapi.mvp_uniform_location_id = GAPI_SHADER_LOCATION_TEXTURE_SHADER_MVP_ID;
+#ifdef VALIDATE
+    glValidateProgram(gapi.shader_program_texture.id);
+    const auto status_reault = check_program_status(gapi.shader_program_texture, GL_VALIDATE_STATUS);
+    result_unwrap(status_reault);
+#endif
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, textureId);
-    glUniform1i(loc, 1);
+    gapi.pipeline.program = gapi.shader_program_texture.id;
+
+    // NOTE: Client references textures by registry handles, unknown ones draw without texture
+    const auto handle = (u64) read_int64(reader);
+    Texture2D const* texture = texture_registry_get(handle);
+
+    gapi.pipeline.texture = texture != nullptr ? texture->id : 0;
+    gapi.pipeline.color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
 }
 
-static void gapi_draw_quads(GApi& gapi, BytesReader* bytes_reader) {
-    glBindVertexArray(gapi.quad_vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.quad_indices_buffer);
+static void gapi_draw_quad_instances(GApi& gapi, BatchPrimitive primitive, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
-    auto const count = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
+    auto const count = (u64) read_int64(reader);
+    u8 const* matrices = read_array(reader, count, sizeof(Mat4f));
+
+    if (matrices == nullptr) {
+        return;
+    }
+
+    gapi_begin_batch(gapi, primitive, gapi.pipeline.program, gapi.pipeline.texture);
 
     for (u64 i = 0; i < count; i += 1) {
-        const auto mvp_mat = read_mat4f(bytes_reader);
-        const auto loc = gapi.shader_uniform_locations[gapi.mvp_uniform_location_id];
+        QuadInstance* instance = gapi_batch_push_instance(gapi);
 
-        glUniformMatrix4fv(loc, 1, GL_TRUE, tech_paws_vm_math_mat4fptr(mvp_mat));
-        glDrawElements(GL_TRIANGLE_STRIP, quad_indices_count, GL_UNSIGNED_INT, nullptr);
+        // NOTE: Matrix is copied straight into the mapped stream buffer
+        memcpy(&instance->mvp, matrices + i * sizeof(Mat4f), sizeof(Mat4f));
+        instance->tex_rect = vm_vec4f(0.f, 0.f, 1.f, 1.f);
+        instance->color = gapi.pipeline.color;
     }
 }
 
-static void gapi_draw_centered_quads(GApi& gapi, BytesReader* bytes_reader) {
-    glBindVertexArray(gapi.centered_quad_vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.quad_indices_buffer);
+static void gapi_draw_quads(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+    gapi_draw_quad_instances(gapi, BatchPrimitive::quads, reader);
+}
 
-    auto const count = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
+static void gapi_draw_centered_quads(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+    gapi_draw_quad_instances(gapi, BatchPrimitive::centered_quads, reader);
+}
 
-    for (u64 i = 0; i < count; i += 1) {
-        const auto mvp_mat = read_mat4f(bytes_reader);
-        const auto loc = gapi.shader_uniform_locations[GAPI_SHADER_LOCATION_COLOR_SHADER_MVP_ID];
+static void gapi_draw_lines(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
-        glUniformMatrix4fv(loc, 1, GL_TRUE, tech_paws_vm_math_mat4fptr(mvp_mat));
-        glDrawElements(GL_TRIANGLE_STRIP, quad_indices_count, GL_UNSIGNED_INT, nullptr);
+    const auto mvp = glm_mat4(read_mat4f(reader));
+    auto const count = (u64) read_int64(reader);
+
+    u8 const* points = read_array(reader, count, sizeof(Vec2f));
+
+    if (points == nullptr) {
+        return;
+    }
+
+    gapi_begin_batch(gapi, BatchPrimitive::lines, gapi.pipeline.program, gapi.pipeline.texture);
+
+    // NOTE: GL_LINES ignores the last point of odd count
+    for (u64 i = 0; i + 1 < count; i += 2) {
+        LineVertex* vertices = gapi_batch_push_line(gapi);
+
+        vertices[0].position = transform_point(mvp, load_vec2f(points + i * sizeof(Vec2f)));
+        vertices[0].color = gapi.pipeline.color;
+        vertices[1].position = transform_point(mvp, load_vec2f(points + (i + 1) * sizeof(Vec2f)));
+        vertices[1].color = gapi.pipeline.color;
     }
 }
 
-static void gapi_draw_lines(GApi& gapi, BytesReader* bytes_reader) {
-    const auto mvp_mat = read_mat4f(bytes_reader);
-    auto const count = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
+static void gapi_draw_path(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
-    gapi.lines_vertices.clear();
-    gapi.lines_indices.clear();
+    const auto mvp = glm_mat4(read_mat4f(reader));
+    auto const count = (u64) read_int64(reader);
 
-    for (u64 i = 0; i < count; i += 1) {
-        const auto point = read_vec2f(bytes_reader);
-        gapi.lines_vertices.push_back(point);
-        gapi.lines_indices.push_back(i);
+    if (count == 0) {
+        return;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, gapi.lines_indices_buffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(u32) * gapi.lines_indices.size(), &gapi.lines_indices[0], GL_STREAM_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, gapi.lines_vertices_buffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vec2f) * gapi.lines_vertices.size(), &gapi.lines_vertices[0], GL_STREAM_DRAW);
+    u8 const* points = read_array(reader, count, sizeof(Vec2f));
 
-    // draw
-    glBindVertexArray(gapi.lines_vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.lines_indices_buffer);
+    if (points == nullptr) {
+        return;
+    }
+
+    gapi_begin_batch(gapi, BatchPrimitive::lines, gapi.pipeline.program, gapi.pipeline.texture);
+
+    // NOTE: Path is converted into separate segments to be merged with other lines
+    auto last_point = transform_point(mvp, load_vec2f(points));
 
-    const auto loc = gapi.shader_uniform_locations[gapi.mvp_uniform_location_id];
+    for (u64 i = 1; i < count; i += 1) {
+        const auto point = transform_point(mvp, load_vec2f(points + i * sizeof(Vec2f)));
+        LineVertex* vertices = gapi_batch_push_line(gapi);
 
-    glUniformMatrix4fv(loc, 1, GL_TRUE, tech_paws_vm_math_mat4fptr(mvp_mat));
-    glDrawElements(GL_LINES, gapi.lines_indices.size(), GL_UNSIGNED_INT, nullptr);
+        vertices[0].position = last_point;
+        vertices[0].color = gapi.pipeline.color;
+        vertices[1].position = point;
+        vertices[1].color = gapi.pipeline.color;
+
+        last_point = point;
+    }
 }
 
-static void gapi_draw_path(GApi& gapi, BytesReader* bytes_reader) {
-    const auto mvp_mat = read_mat4f(bytes_reader);
-    auto const count = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
+static void gapi_draw_texts(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
-    gapi.lines_vertices.clear();
-    gapi.lines_indices.clear();
+    char from_addr[GAPI_ADDRESS_CAPACITY];
+    const u64 from_addr_len = read_address(reader, &from_addr[0]);
 
-    for (u64 i = 0; i < count; i += 1) {
-        const auto point = read_vec2f(bytes_reader);
-        gapi.lines_vertices.push_back(point);
-        gapi.lines_indices.push_back(i);
+    if (from_addr_len == 0) {
+        return;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, gapi.lines_indices_buffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(u32) * gapi.lines_indices.size(), &gapi.lines_indices[0], GL_STREAM_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, gapi.lines_vertices_buffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vec2f) * gapi.lines_vertices.size(), &gapi.lines_vertices[0], GL_STREAM_DRAW);
+    auto const count = (u64) read_int64(reader);
 
-    // draw
-    glBindVertexArray(gapi.lines_vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.lines_indices_buffer);
+    // NOTE: Only the debug font is supported, font id of the texts is skipped
+    for (u64 i = 0; i < count; i += 1) {
+        read_int64(reader);
+        const auto font_size = (u32) read_int32(reader);
+        const auto mvp_matrix = read_mat4f(reader);
 
-    const auto loc = gapi.shader_uniform_locations[gapi.mvp_uniform_location_id];
+        // read text
+        const auto str_len = (u64) read_int64(reader);
+        const auto str_buff = read_array(reader, str_len, 1);
 
-    glUniformMatrix4fv(loc, 1, GL_TRUE, tech_paws_vm_math_mat4fptr(mvp_mat));
-    glDrawElements(GL_LINE_STRIP, gapi.lines_indices.size(), GL_UNSIGNED_INT, nullptr);
-}
+        if (str_buff == nullptr) {
+            return;
+        }
+
+        if (str_len == 0) {
+            continue;
+        }
 
-static Texture2D update_texture_2d(Texture2D texture, Texture2DParameters params) {
-    const auto wrap_s = params.wrap_s ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-    const auto wrap_t = params.wrap_t ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-    const auto min_filter = params.min_filter ? GL_LINEAR : GL_NEAREST;
-    const auto mag_filter = params.mag_filter ? GL_LINEAR : GL_NEAREST;
+        auto atlas_result = glyph_atlas_get(gapi, gapi.debug_font, font_size);
+        GlyphAtlas* atlas = result_unwrap(atlas_result);
 
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+        // NOTE: Glyphs of the same atlas are merged into one batch
+        gapi_begin_batch(gapi, BatchPrimitive::quads, gapi.shader_program_texture.id, atlas->texture.id);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t);
+        const auto mvp = glm_mat4(mvp_matrix);
+        u32 pen_x = 0;
 
-    return texture;
+        for (u64 j = 0; j < str_len; j += 1) {
+            auto glyph_result = glyph_atlas_get_glyph(gapi, atlas, (u8) str_buff[j]);
+            const Glyph* glyph = result_unwrap(glyph_result);
+
+            if (glyph->width > 0) {
+                const auto model = glm::scale(
+                    glm::translate(glm::mat4(1), glm::vec3(pen_x, 0.0f, 0.0f)),
+                    glm::vec3(glyph->width, glyph->height, 1.0f)
+                );
+
+                QuadInstance* instance = gapi_batch_push_instance(gapi);
+
+                instance->mvp = vm_mat4f(mvp * model);
+                instance->tex_rect = glyph_atlas_get_tex_rect(atlas, glyph);
+                instance->color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+            }
+
+            pen_x += glyph->advance;
+        }
+
+        // Send calculated boundary
+        push_text_boundary(&from_addr[0], pen_x, atlas->line_height);
+    }
 }
 
-static Texture2D create_texture_2d_from_sdl_surface(SDL_Surface const* surface, Texture2DParameters params) {
-    Texture2D texture;
-    glGenTextures(1, &texture.id);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+static void gapi_set_viewport(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
 
-    texture.width = surface->w;
-    texture.height = surface->h;
+    const auto x = (u32) read_int32(reader);
+    const auto y = (u32) read_int32(reader);
+    const auto w = (u32) read_int32(reader);
+    const auto h = (u32) read_int32(reader);
 
-    const auto format = surface->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB;
-    glTexImage2D(
-        /* target */ GL_TEXTURE_2D,
-        /* level */ 0,
-        /* internalformat */ format,
-        /* width */ texture.width,
-        /* height */ texture.height,
-        /* border */ 0,
-        /* format */ format,
-        /* type */ GL_UNSIGNED_BYTE,
-        /* data */ surface->pixels
-    );
+    gapi_flush_batch(gapi);
+    gl_state_viewport(&gapi.gl_state, x, y, w, h);
+}
 
-    return update_texture_2d(texture, params);
+void gapi_render(GApi& gapi) {
+    const auto commands_buffer = tech_paws_vm_get_commands_buffer();
+    gapi_render_buffer(gapi, commands_buffer.base, commands_buffer.size);
 }
 
-static void push_text_boundary(char const* to, float w, float h) {
-    const auto bytes_writer = tech_paws_begin_command(to, Source::Processor, COMMAND_ADD_TEXT_BOUNDARIES);
+static bool gapi_is_built_in_draw(CommandTable const* table, u64 command_id) {
+    const CommandHandler handler = command_table_get(table, command_id);
+
+    switch (command_id) {
+        case COMMAND_GAPI_DRAW_QUADS:
+            return handler == gapi_draw_quads;
 
-    vm_buffers_bytes_writer_write_float(bytes_writer, w);
-    vm_buffers_bytes_writer_write_float(bytes_writer, h);
+        case COMMAND_GAPI_DRAW_CENTERED_QUADS:
+            return handler == gapi_draw_centered_quads;
 
-    tech_paws_end_command(to, Source::Processor);
+        case COMMAND_GAPI_DRAW_LINES:
+            return handler == gapi_draw_lines;
+
+        case COMMAND_GAPI_DRAW_PATH:
+            return handler == gapi_draw_path;
+
+        default:
+            return false;
+    }
 }
 
-static void gapi_draw_texts(GApi& gapi, BytesReader* bytes_reader) {
-    // read from address
-    const auto from_addr_len = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
-    const auto from_addr_buff = vm_buffers_bytes_reader_read_bytes_buffer(bytes_reader, from_addr_len);
+// Collects commands of the frame and expands their draws ahead of submission,
+// returns false when the frame should be decoded by handlers as it goes.
+// Counts quads and line segments of the built-in draws, the reader is a copy,
+// so the commands can still be walked by the caller.
+static u64 gapi_count_prepared_elements(GApi& gapi, CommandsReader commands_reader) {
+    const Vec4f color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+    CommandHeader header;
+    PreparedCommand command;
+    u64 elements_count = 0;
+
+    while (commands_reader_next(&commands_reader, &header)) {
+        if (gapi_is_built_in_draw(&gapi.commands, header.id) && prepared_command_init(&command, header, color)) {
+            elements_count += command.count;
+        }
+    }
 
-    char from_addr[256] = {};
-    memcpy(&from_addr[0], from_addr_buff, (size_t) from_addr_len);
-    from_addr[from_addr_len] = '\0';
+    return elements_count;
+}
 
-    if (from_addr_len == 0) {
-        return;
+static bool gapi_prepare_frame(GApi& gapi, CommandsReader* commands_reader, PreparedFrame* frame) {
+    PROFILE_FUNCTION();
+    MEMORY_TAG("gapi/prepared_frame");
+
+    CommandTable const* table = &gapi.commands;
+
+    // NOTE: Pipeline color of draws is tracked here, so custom pipeline handlers disable it
+    if (gapi.frame_allocator == nullptr ||
+        job_system_get_workers_count() == 0 ||
+        command_table_get(table, COMMAND_GAPI_SET_COLOR_PIPELINE) != gapi_set_color_pipeline ||
+        command_table_get(table, COMMAND_GAPI_SET_TEXTURE_PIPELINE) != gapi_set_texture_pipeline)
+    {
+        return false;
     }
 
-    auto const count = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
+    // NOTE: Small frames go through the handlers, which write straight into the stream buffers,
+    // expanding them first would only add a copy
+    if (gapi_count_prepared_elements(gapi, *commands_reader) < GAPI_PREPARE_MIN_ELEMENTS) {
+        return false;
+    }
 
-    for (u64 i = 0; i < count; i += 1) {
-        const auto font_id = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
-        const auto font_size = (u32) vm_buffers_bytes_reader_read_int32_t(bytes_reader);
-        const auto mvp_matrix = read_mat4f(bytes_reader);
+    // NOTE: Every command takes at least its header, so count can't be trusted for the allocation
+    const u64 max_commands = (commands_reader->size - commands_reader->offset) / (sizeof(u64) * 2);
+    const u64 capacity = commands_reader->count < max_commands ? commands_reader->count : max_commands;
+    const auto commands_result = frame_push<PreparedCommand>(gapi.frame_allocator, capacity);
 
-        // read text
-        const auto str_len = (u64) vm_buffers_bytes_reader_read_int64_t(bytes_reader);
-        const auto str_buff = vm_buffers_bytes_reader_read_bytes_buffer(bytes_reader, str_len);
+    if (result_has_error(commands_result)) {
+        return false;
+    }
 
-        char text[256] = {};
-        memcpy(&text[0], str_buff, (size_t) str_len);
-        text[str_len] = '\0';
+    frame->commands = result_get_payload(commands_result);
+    frame->commands_count = 0;
+    frame->elements_count = 0;
 
-        if (str_len == 0) {
-            return;
+    Vec4f color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+    CommandHeader header;
+
+    while (commands_reader_next(commands_reader, &header)) {
+        PreparedCommand* command = &frame->commands[frame->commands_count];
+        frame->commands_count += 1;
+
+        if (header.id == COMMAND_GAPI_SET_COLOR_PIPELINE && header.size >= sizeof(Vec4f)) {
+            memcpy(&color, header.payload, sizeof(Vec4f));
+        }
+        else if (header.id == COMMAND_GAPI_SET_TEXTURE_PIPELINE) {
+            color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
         }
 
-        const auto color = SDL_Color { 255, 255, 255 };
-        auto font_result = get_sdl2_ttf_font(gapi.debug_font, font_size);
-        const auto font = result_unwrap(font_result);
+        const bool is_draw = gapi_is_built_in_draw(table, header.id) && prepared_command_init(command, header, color);
 
-        SDL_Surface* surface = TTF_RenderText_Blended(font, &text[0], color);
+        if (is_draw && command->count > 0) {
+            const size_t size = prepared_element_size(command->primitive) * command->count;
+            // NOTE: Draws expanded by different jobs never share a cache line at their boundaries
+            const auto data_result = frame_allocator_alloc(gapi.frame_allocator, size, MEMORY_CACHE_LINE_SIZE);
 
-        if (!surface) {
-            result_unwrap(
-                result_create_general_error<bool>(
-                    ErrorCode::RenderText,
-                    TTF_GetError()
-                )
-            );
+            if (result_is_success(data_result)) {
+                command->data = result_get_payload(data_result);
+                command->first_element = frame->elements_count;
+                frame->elements_count += command->count;
+                continue;
+            }
         }
 
-        const Texture2DParameters params = {
-            .min_filter = false,
-            .mag_filter = false
-        };
+        // NOTE: Executed by its handler during submission
+        prepared_command_init(command, header, color);
+        command->primitive = BatchPrimitive::none;
+        command->count = 0;
+        command->first_element = frame->elements_count;
+    }
 
-        auto const texture = create_texture_2d_from_sdl_surface(surface, params);
+    prepared_frame_expand(frame, gapi.frame_allocator);
+    return true;
+}
 
-        glBindTexture(GL_TEXTURE_2D, texture.id);
+// Copies draw expanded ahead of submission into the current batch.
+static void gapi_submit_prepared(GApi& gapi, PreparedCommand const& command) {
+    gapi_begin_batch(gapi, command.primitive, gapi.pipeline.program, gapi.pipeline.texture);
 
-        // glBindVertexArray(gapi.quad_vao);
-        // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.quad_indices_buffer);
-        glBindVertexArray(gapi.quad_vao);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gapi.quad_indices_buffer);
+    const size_t element_size = prepared_element_size(command.primitive);
+    u64 submitted = 0;
 
-        const auto loc = gapi.shader_uniform_locations[gapi.mvp_uniform_location_id];
+    while (submitted < command.count) {
+        u8 const* source = command.data + submitted * element_size;
+        u64 pushed;
 
-        const auto scale_matrix = glm::scale(
-            glm::mat4(1),
-            glm::vec3(surface->w, surface->h, 1.0f)
-        );
+        if (command.primitive == BatchPrimitive::lines) {
+            LineVertex* vertices = gapi_batch_push_lines(gapi, command.count - submitted, &pushed);
+            memcpy(vertices, source, pushed * element_size);
+        }
+        else {
+            QuadInstance* instances = gapi_batch_push_instances(gapi, command.count - submitted, &pushed);
+            memcpy(instances, source, pushed * element_size);
+        }
 
-        auto mvp = glm_mat4(mvp_matrix);
-        mvp = mvp * scale_matrix;
-        auto mat = vm_mat4f(mvp);
+        submitted += pushed;
+    }
+}
 
-        glUniformMatrix4fv(loc, 1, GL_TRUE, tech_paws_vm_math_mat4fptr(&mat));
-        glDrawElements(GL_TRIANGLE_STRIP, quad_indices_count, GL_UNSIGNED_INT, nullptr);
+static void gapi_request_frame_stats(GApi& gapi, CommandReader* reader) {
+    gapi.frame_stats_requested = true;
+}
 
-        // Send calculated boundary
-        push_text_boundary(&from_addr[0], surface->w, surface->h);
+static void init_command_handlers(GApi& gapi) {
+    CommandTable* table = &gapi.commands;
 
-        SDL_FreeSurface(surface);
-    }
+    command_table_register(table, COMMAND_GAPI_SET_COLOR_PIPELINE, gapi_set_color_pipeline);
+    command_table_register(table, COMMAND_GAPI_SET_TEXTURE_PIPELINE, gapi_set_texture_pipeline);
+    command_table_register(table, COMMAND_GAPI_DRAW_CENTERED_QUADS, gapi_draw_centered_quads);
+    command_table_register(table, COMMAND_GAPI_DRAW_QUADS, gapi_draw_quads);
+    command_table_register(table, COMMAND_GAPI_DRAW_LINES, gapi_draw_lines);
+    command_table_register(table, COMMAND_GAPI_DRAW_PATH, gapi_draw_path);
+    command_table_register(table, COMMAND_GAPI_DRAW_TEXTS, gapi_draw_texts);
+    command_table_register(table, COMMAND_GAPI_SET_VIEWPORT, gapi_set_viewport);
+
+    // NOTE: Every request gets one reply, so it isn't handled again on redraws
+    command_table_register(&gapi.buffer_commands, COMMAND_STATE_REQUEST_FRAME_STATS, gapi_request_frame_stats);
 }
 
-static void gapi_set_viewport(GApi& gapi, BytesReader* bytes_reader) {
-    puts("set viewport");
-    const auto x = (u32) vm_buffers_bytes_reader_read_int32_t(bytes_reader);
-    const auto y = (u32) vm_buffers_bytes_reader_read_int32_t(bytes_reader);
-    const auto w = (u32) vm_buffers_bytes_reader_read_int32_t(bytes_reader);
-    const auto h = (u32) vm_buffers_bytes_reader_read_int32_t(bytes_reader);
-    glViewport(x, y, w, h);
+bool gapi_register_command_handler(GApi& gapi, u64 command_id, CommandHandler handler) {
+    return command_table_register(&gapi.commands, command_id, handler);
 }
 
-void gapi_render(GApi& gapi) {
-    const auto commands_buffer = tech_paws_vm_get_commands_buffer();
-    auto bytes_reader = vm_buffers_create_bytes_reader(ByteOrder::LittleEndian, commands_buffer.base, (size_t) commands_buffer.size);
-    const auto count = (uint64_t) vm_buffers_bytes_reader_read_int64_t(&bytes_reader);
+bool gapi_register_buffer_command_handler(GApi& gapi, u64 command_id, CommandHandler handler) {
+    return command_table_register(&gapi.buffer_commands, command_id, handler);
+}
 
-    // read text
-    const auto str_len = (u64) vm_buffers_bytes_reader_read_int64_t(&bytes_reader);
-    const auto str_buff = vm_buffers_bytes_reader_read_bytes_buffer(&bytes_reader, str_len);
+void gapi_process_buffer_commands(GApi& gapi, u8* base, u64 size) {
+    PROFILE_FUNCTION();
+    dispatch_buffer_commands(gapi, &gapi.buffer_commands, base, size);
+}
+
+void gapi_set_frame_allocator(GApi& gapi, FrameAllocator* allocator) {
+    gapi.frame_allocator = allocator;
+}
 
-    char from_address[256] = {};
-    memcpy(&from_address[0], str_buff, (size_t) str_len);
-    from_address[str_len] = '\0';
+void gapi_render_buffer(GApi& gapi, u8* base, u64 size) {
+    PROFILE_FUNCTION();
+
+    CommandsReader commands_reader;
+    char from_address[GAPI_ADDRESS_CAPACITY];
+    const u64 str_len = commands_reader_init(&commands_reader, base, size, &from_address[0]);
 
     if (str_len == 0) {
         return;
     }
 
-    for (int i = 0; i < count; i += 1) {
-        const auto command_id = (uint64_t) vm_buffers_bytes_reader_read_int64_t(&bytes_reader);
-        const auto skip = (uint64_t) vm_buffers_bytes_reader_read_int64_t(&bytes_reader);
+    gapi_begin_streams(gapi);
+    gpu_timer_begin_frame(&gapi.gpu_timer);
+
+    gapi.frame_stats.command_bytes += sizeof(u64) * 2 + str_len;
+    gapi.batch = {};
+    gapi.pipeline.program = gapi.shader_program_color.id;
+    gapi.pipeline.texture = 0;
+    gapi.pipeline.color = vm_vec4f(1.f, 1.f, 1.f, 1.f);
+
+    PreparedFrame prepared_frame;
+
+    if (gapi_prepare_frame(gapi, &commands_reader, &prepared_frame)) {
+        // NOTE: Submission stays in order on this thread, texts and state commands
+        // are executed by their handlers as before.
+        for (u64 i = 0; i < prepared_frame.commands_count; i += 1) {
+            PreparedCommand const& command = prepared_frame.commands[i];
+
+            gapi.frame_stats.commands += 1;
+            gapi.frame_stats.command_bytes += sizeof(u64) * 2 + command.header.size;
+            gapi.command_id = command.header.id;
+
+            if (command.data != nullptr) {
+                gapi_submit_prepared(gapi, command);
+            }
+            else if (!dispatch_command(gapi, &gapi.commands, command.header) && command_table_get(&gapi.buffer_commands, command.header.id) == nullptr) {
+                gapi.frame_stats.commands_skipped += 1;
+            }
+        }
+    }
+    else {
+        CommandHeader command;
 
-        switch (command_id) {
-            case COMMAND_GAPI_SET_COLOR_PIPELINE:
-                gapi_set_color_pipeline(gapi, &bytes_reader);
-                break;
+        while (commands_reader_next(&commands_reader, &command)) {
+            gapi.frame_stats.commands += 1;
+            gapi.frame_stats.command_bytes += sizeof(u64) * 2 + command.size;
+            gapi.command_id = command.id;
 
-            case COMMAND_GAPI_SET_TEXTURE_PIPELINE:
-                gapi_set_texture_pipeline(gapi, &bytes_reader);
-                break;
+            // NOTE: Buffer commands have already been handled by gapi_process_buffer_commands
+            if (!dispatch_command(gapi, &gapi.commands, command) && command_table_get(&gapi.buffer_commands, command.id) == nullptr) {
+                gapi.frame_stats.commands_skipped += 1;
+            }
+        }
+    }
 
-            case COMMAND_GAPI_DRAW_CENTERED_QUADS:
-                gapi_draw_centered_quads(gapi, &bytes_reader);
-                break;
+    if (commands_reader.malformed) {
+        log_error(
+            "Malformed commands buffer, rendered %llu of %llu commands",
+            (unsigned long long) commands_reader.index,
+            (unsigned long long) commands_reader.count
+        );
+    }
 
-            case COMMAND_GAPI_DRAW_QUADS:
-                gapi_draw_quads(gapi, &bytes_reader);
-                break;
+    gapi_flush_batch(gapi);
+    gapi_end_streams(gapi);
+    gpu_timer_end_frame(&gapi.gpu_timer);
 
-            case COMMAND_GAPI_DRAW_LINES:
-                gapi_draw_lines(gapi, &bytes_reader);
-                break;
+    gapi.frame_stats.state_changes = gapi.gl_state.calls;
+    gapi.frame_stats.state_changes_elided = gapi.gl_state.elided_calls;
+    gapi.frame_stats.memory_high_water = gapi.memory.high_water;
+    gapi.gl_state.calls = 0;
+    gapi.gl_state.elided_calls = 0;
 
-            case COMMAND_GAPI_DRAW_PATH:
-                gapi_draw_path(gapi, &bytes_reader);
-                break;
+    gapi.last_frame_stats = gapi.frame_stats;
+    gapi.frame_stats = {};
+}
 
-            case COMMAND_GAPI_DRAW_TEXTS:
-                gapi_draw_texts(gapi, &bytes_reader);
-                break;
+MemoryUsage gapi_get_memory_usage(GApi& gapi) {
+    return region_memory_buffer_get_usage(&gapi.memory);
+}
 
-            case COMMAND_GAPI_SET_VIEWPORT:
-                gapi_set_viewport(gapi, &bytes_reader);
-                break;
+GApiFrameStats gapi_get_frame_stats(GApi& gapi) {
+    return gapi.last_frame_stats;
+}
 
-            default:
-                vm_buffers_bytes_reader_skip(&bytes_reader, (size_t) skip);
-                log_error("Unknown command id: 0x%.8llx", command_id);
+bool gapi_consume_frame_stats_request(GApi& gapi) {
+    const bool requested = gapi.frame_stats_requested;
+    gapi.frame_stats_requested = false;
+    return requested;
+}
+
+size_t gapi_get_command_gpu_times(GApi& gapi, GApiCommandGpuTime* times, size_t capacity) {
+    const GpuTimer& timer = gapi.gpu_timer;
+    size_t count = 0;
+
+    for (u32 i = 0; i < timer.commands_count && count < capacity; i += 1) {
+        const GpuCommandTime& command = timer.commands[i];
+
+        if (command.frames == 0) {
+            continue;
         }
+
+        times[count] = {
+            .command_id = command.command_id,
+            .frames = command.frames,
+            .average_ms = (f64) command.total_ns / (f64) command.frames / 1e6,
+            .max_ms = (f64) command.max_frame_ns / 1e6,
+            .last_frame_ms = (f64) command.last_frame_ns / 1e6,
+        };
+
+        count += 1;
     }
+
+    return count;
+}
+
+f64 gapi_get_gpu_frame_time(GApi& gapi) {
+    return (f64) gapi.gpu_timer.last_frame_ns / 1e6;
+}
+
+void gapi_reset_command_gpu_times(GApi& gapi) {
+    gpu_timer_reset_commands(&gapi.gpu_timer);
 }
 
 void collect_text_bounds(GApi& gapi) {
 }
 
-void gapi_set_viewport(int x, int y, int width, int height) {
-    glViewport(x, y , width, height);
+void gapi_set_viewport(GApi& gapi, int x, int y, int width, int height) {
+    gl_state_viewport(&gapi.gl_state, x, y, width, height);
 }
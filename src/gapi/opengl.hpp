@@ -1,10 +1,14 @@
 #pragma once
 
-#include <vector>
 #include <GL/glew.h>
 #include "memory.hpp"
+#include "frame_allocator.hpp"
 #include "shell_config.hpp"
 #include "vm_math.hpp"
+#include "gapi/opengl_state.hpp"
+#include "gapi/opengl_stream_buffer.hpp"
+#include "gapi/opengl_gpu_timer.hpp"
+#include "gapi/command_table.hpp"
 
 enum class ShaderType {
     vertex,
@@ -37,18 +41,80 @@ static const size_t GAPI_SHADER_FRAGMENT_COLOR_ID = 0;
 static const size_t GAPI_SHADER_FRAGMENT_TEXTURE_ID = 1;
 static const size_t GAPI_SHADER_VERTEX_TRANSFORM_ID = 2;
 
-static const size_t GAPI_SHADER_LOCATION_TEXTURE_SHADER_MVP_ID = 0;
-static const size_t GAPI_SHADER_LOCATION_TEXTURE_SHADER_TEXTURE_ID = 1;
-static const size_t GAPI_SHADER_LOCATION_COLOR_SHADER_MVP_ID = 2;
-static const size_t GAPI_SHADER_LOCATION_COLOR_SHADER_COLOR_ID = 3;
+static const size_t GAPI_SHADER_LOCATION_TEXTURE_SHADER_TEXTURE_ID = 0;
+
+// NOTE: Textures are created and updated on a separate unit to not break draw state
+static const u32 GAPI_TEXTURE_UNIT_UPLOAD = 0;
+static const u32 GAPI_TEXTURE_UNIT_DRAW = 1;
+
+static const u32 GAPI_ATTRIBUTE_POSITION = 0;
+static const u32 GAPI_ATTRIBUTE_TEX_COORD = 1;
+// NOTE: mat4 attribute occupies 4 consecutive locations (2..5)
+static const u32 GAPI_ATTRIBUTE_INSTANCE_MVP = 2;
+static const u32 GAPI_ATTRIBUTE_INSTANCE_TEX_RECT = 6;
+// NOTE: Per instance for quads and per vertex for lines
+static const u32 GAPI_ATTRIBUTE_COLOR = 7;
+
+// Max number of instances and line vertices per frame, when a frame needs more
+// the renderer has to wait for the GPU to reuse the frame section of the stream buffer.
+static const size_t GAPI_INSTANCES_CAPACITY = 16384;
+static const size_t GAPI_LINES_VERTICES_CAPACITY = 65536;
+
+struct QuadInstance {
+    Mat4f mvp;
+    // Region of the bound texture as (x, y, width, height) in texture coordinates
+    Vec4f tex_rect;
+    Vec4f color;
+};
+
+struct LineVertex {
+    // NOTE: Already transformed by MVP
+    Vec4f position;
+    Vec4f color;
+};
+
+enum class BatchPrimitive {
+    none,
+    quads,
+    centered_quads,
+    lines,
+};
+
+struct BatchState {
+    BatchPrimitive primitive;
+    GLuint program;
+    GLuint texture;
+};
+
+// Draws with the same state accumulated to be submitted with one draw call.
+struct Batch {
+    BatchState state;
+    // NOTE: GPU time of the batch is attributed to the command that started it
+    u64 command_id;
+    u32 first_instance;
+    u64 instances_count;
+    u32 first_vertex;
+    u64 vertices_count;
+};
+
+// State requested by the last SET_*_PIPELINE command.
+struct Pipeline {
+    GLuint program;
+    GLuint texture;
+    Vec4f color;
+};
 
 struct GApi {
     ShellConfig config;
     RegionMemoryBuffer memory;
+    // Owned by the shell, shaders and fonts are loaded into it
+    GrowableRegionMemoryBuffer* assets_memory;
+    // Owned by the shell, nullptr until it's set
+    FrameAllocator* frame_allocator;
 
     Shader shaders[3];
     ShaderProgram shader_programs[2];
-    u32 shader_uniform_locations[4];
+    u32 shader_uniform_locations[1];
     GLuint buffers[8];
 
     Font* debug_font;
@@ -66,12 +132,27 @@ struct GApi {
     GLuint centered_quad_tex_coords_buffer;
     GLuint centered_quad_vao;
 
-    GLuint lines_indices_buffer;
-    GLuint lines_vertices_buffer;
     GLuint lines_vao;
-
-    std::vector<Vec2f> lines_vertices;
-    std::vector<i32> lines_indices;
-
-    size_t mvp_uniform_location_id;
+    StreamBuffer lines_stream;
+    LineVertex* lines_vertices;
+    size_t lines_vertices_count;
+
+    StreamBuffer instances_stream;
+    QuadInstance* instances;
+    size_t instances_count;
+
+    CommandTable commands;
+    // Commands handled once per commands buffer, see gapi_process_buffer_commands
+    CommandTable buffer_commands;
+    GLState gl_state;
+    Pipeline pipeline;
+    Batch batch;
+    // NOTE: Current frame stats are collected until the end of gapi_render
+    GApiFrameStats frame_stats;
+    GApiFrameStats last_frame_stats;
+    bool frame_stats_requested;
+
+    // Id of the command being executed
+    u64 command_id;
+    GpuTimer gpu_timer;
 };
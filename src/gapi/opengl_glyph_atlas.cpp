@@ -0,0 +1,184 @@
+#include "gapi/opengl_glyph_atlas.hpp"
+#include "platform.hpp"
+#include "memory_tracking.hpp"
+
+static u32 next_power_of_two(u32 value) {
+    u32 result = 1;
+
+    while (result < value) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+static Result<GlyphAtlas*> create_glyph_atlas(GApi& gapi, TTF_Font* font) {
+    MEMORY_TAG("gapi/glyph_atlas");
+    const auto atlas_result = region_push<GlyphAtlas>(&gapi.memory, 1);
+
+    if (result_has_error(atlas_result)) {
+        return atlas_result;
+    }
+
+    GlyphAtlas* atlas = result_get_payload(atlas_result);
+    *atlas = {};
+
+    atlas->font = font;
+    atlas->line_height = TTF_FontHeight(font);
+
+    // NOTE: Glyphs are at most about line height wide, so reserve space
+    // for GLYPH_ATLAS_GLYPHS_PER_ROW square cells per row.
+    const u32 cell_size = atlas->line_height + GLYPH_ATLAS_PADDING;
+    u32 size = next_power_of_two(cell_size * GLYPH_ATLAS_GLYPHS_PER_ROW);
+
+    if (size > GLYPH_ATLAS_MAX_SIZE) {
+        size = GLYPH_ATLAS_MAX_SIZE;
+    }
+
+    atlas->texture.width = size;
+    atlas->texture.height = size;
+
+    glGenTextures(1, &atlas->texture.id);
+    gl_state_bind_texture(&gapi.gl_state, GAPI_TEXTURE_UNIT_UPLOAD, atlas->texture.id);
+
+    glTexImage2D(
+        /* target */ GL_TEXTURE_2D,
+        /* level */ 0,
+        /* internalformat */ GL_RGBA8,
+        /* width */ size,
+        /* height */ size,
+        /* border */ 0,
+        /* format */ GL_BGRA,
+        /* type */ GL_UNSIGNED_BYTE,
+        /* data */ nullptr
+    );
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    log_info("Created glyph atlas %dx%d for line height %d", size, size, atlas->line_height);
+    return result_create_success(atlas);
+}
+
+Result<GlyphAtlas*> glyph_atlas_get(GApi& gapi, Font* font, u32 font_size) {
+    const auto font_size_result = get_sdl2_font_size(font, font_size);
+
+    if (result_has_error(font_size_result)) {
+        return switch_error<GlyphAtlas*>(font_size_result);
+    }
+
+    FontSize* size = result_get_payload(font_size_result);
+
+    if (size->atlas == nullptr) {
+        const auto atlas_result = create_glyph_atlas(gapi, size->font);
+
+        if (result_has_error(atlas_result)) {
+            return atlas_result;
+        }
+
+        size->atlas = result_get_payload(atlas_result);
+    }
+
+    return result_create_success(size->atlas);
+}
+
+static Result<bool> rasterize_glyph(GApi& gapi, GlyphAtlas* atlas, Glyph* glyph, u8 code) {
+    glyph->rasterized = true;
+
+    int min_x, max_x, min_y, max_y, advance;
+
+    if (TTF_GlyphMetrics(atlas->font, code, &min_x, &max_x, &min_y, &max_y, &advance) < 0) {
+        // NOTE: Glyph is not provided by the font, it will be skipped
+        return result_create_success(true);
+    }
+
+    glyph->advance = advance;
+
+    const auto color = SDL_Color { 255, 255, 255, 255 };
+    const char text[2] = { (char) code, 0 };
+
+    // NOTE: Whitespaces don't need a place in the atlas
+    if (code == ' ') {
+        return result_create_success(true);
+    }
+
+    SDL_Surface* surface = TTF_RenderText_Blended(atlas->font, &text[0], color);
+
+    if (!surface) {
+        return result_create_general_error<bool>(
+            ErrorCode::RenderText,
+            TTF_GetError()
+        );
+    }
+
+    const u32 width = surface->w;
+    const u32 height = surface->h;
+
+    if (atlas->pen_x + width > atlas->texture.width) {
+        atlas->pen_x = 0;
+        atlas->pen_y += atlas->line_height + GLYPH_ATLAS_PADDING;
+    }
+
+    if (atlas->pen_y + height > atlas->texture.height || width > atlas->texture.width) {
+        SDL_FreeSurface(surface);
+        log_warn("Glyph atlas is full, glyph %d will be skipped", code);
+        return result_create_success(true);
+    }
+
+    glyph->x = atlas->pen_x;
+    glyph->y = atlas->pen_y;
+    glyph->width = width;
+    glyph->height = height;
+
+    atlas->pen_x += width + GLYPH_ATLAS_PADDING;
+
+    // NOTE: Blended surfaces are always 32 bit ARGB
+    gl_state_bind_texture(&gapi.gl_state, GAPI_TEXTURE_UNIT_UPLOAD, atlas->texture.id);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / 4);
+    glTexSubImage2D(
+        /* target */ GL_TEXTURE_2D,
+        /* level */ 0,
+        /* xoffset */ glyph->x,
+        /* yoffset */ glyph->y,
+        /* width */ width,
+        /* height */ height,
+        /* format */ GL_BGRA,
+        /* type */ GL_UNSIGNED_BYTE,
+        /* data */ surface->pixels
+    );
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    gapi.frame_stats.texture_uploads += 1;
+    gapi.frame_stats.texture_upload_bytes += width * height * 4;
+
+    SDL_FreeSurface(surface);
+    return result_create_success(true);
+}
+
+Result<Glyph*> glyph_atlas_get_glyph(GApi& gapi, GlyphAtlas* atlas, u8 code) {
+    Glyph* glyph = &atlas->glyphs[code];
+
+    if (!glyph->rasterized) {
+        const auto rasterize_result = rasterize_glyph(gapi, atlas, glyph, code);
+
+        if (result_has_error(rasterize_result)) {
+            return switch_error<Glyph*>(rasterize_result);
+        }
+    }
+
+    return result_create_success(glyph);
+}
+
+Vec4f glyph_atlas_get_tex_rect(GlyphAtlas const* atlas, Glyph const* glyph) {
+    const f32 width = atlas->texture.width;
+    const f32 height = atlas->texture.height;
+
+    return vm_vec4f(
+        glyph->x / width,
+        glyph->y / height,
+        glyph->width / width,
+        glyph->height / height
+    );
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <SDL2/SDL_ttf.h>
+#include "primitives.hpp"
+#include "memory.hpp"
+#include "gapi/opengl.hpp"
+
+struct Font;
+
+// NOTE: Texts are rendered byte by byte, same as TTF_RenderText does
+static const size_t GLYPH_ATLAS_GLYPHS_COUNT = 256;
+static const u32 GLYPH_ATLAS_GLYPHS_PER_ROW = 16;
+static const u32 GLYPH_ATLAS_PADDING = 1;
+static const u32 GLYPH_ATLAS_MAX_SIZE = 4096;
+
+struct Glyph {
+    bool rasterized;
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+    i32 advance;
+};
+
+// Atlas of glyphs rasterized for a single font size, glyphs are
+// packed into rows and rasterized on first use.
+struct GlyphAtlas {
+    TTF_Font* font;
+    Texture2D texture;
+    u32 line_height;
+    u32 pen_x;
+    u32 pen_y;
+    Glyph glyphs[GLYPH_ATLAS_GLYPHS_COUNT];
+};
+
+Result<GlyphAtlas*> glyph_atlas_get(GApi& gapi, Font* font, u32 font_size);
+
+Result<Glyph*> glyph_atlas_get_glyph(GApi& gapi, GlyphAtlas* atlas, u8 code);
+
+Vec4f glyph_atlas_get_tex_rect(GlyphAtlas const* atlas, Glyph const* glyph);
@@ -0,0 +1,153 @@
+#include "gapi/opengl_gpu_timer.hpp"
+
+void gpu_timer_init(GpuTimer* timer) {
+    *timer = {};
+
+    // NOTE: GL_TIME_ELAPSED queries are core since OpenGL 3.3
+    timer->supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+
+    if (!timer->supported) {
+        log_warn("Timer queries aren't supported, GPU times won't be collected");
+        return;
+    }
+
+    for (u32 i = 0; i < GPU_TIMER_FRAMES; i += 1) {
+        GpuTimerFrame& frame = timer->frames[i];
+
+        for (u32 j = 0; j < GPU_TIMER_QUERIES_PER_FRAME; j += 1) {
+            glGenQueries(1, &frame.queries[j].id);
+        }
+    }
+}
+
+static GpuCommandTime* gpu_timer_get_command(GpuTimer* timer, u64 command_id) {
+    for (u32 i = 0; i < timer->commands_count; i += 1) {
+        if (timer->commands[i].command_id == command_id) {
+            return &timer->commands[i];
+        }
+    }
+
+    if (timer->commands_count == GPU_TIMER_COMMANDS_CAPACITY) {
+        return nullptr;
+    }
+
+    GpuCommandTime* command = &timer->commands[timer->commands_count];
+    timer->commands_count += 1;
+
+    *command = {};
+    command->command_id = command_id;
+
+    return command;
+}
+
+static void gpu_timer_resolve_frame(GpuTimer* timer, GpuTimerFrame& frame) {
+    if (frame.queries_count == 0) {
+        return;
+    }
+
+    // NOTE: Queries complete in order, so the last one is enough to check
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.queries_count - 1].id, GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (!available) {
+        timer->frames_dropped += 1;
+        return;
+    }
+
+    u64 frame_ns = 0;
+
+    for (u32 i = 0; i < timer->commands_count; i += 1) {
+        timer->commands[i].last_frame_ns = 0;
+    }
+
+    for (u32 i = 0; i < frame.queries_count; i += 1) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(frame.queries[i].id, GL_QUERY_RESULT, &elapsed);
+
+        frame_ns += elapsed;
+        GpuCommandTime* command = gpu_timer_get_command(timer, frame.queries[i].command_id);
+
+        if (command != nullptr) {
+            command->samples += 1;
+            command->total_ns += elapsed;
+            command->last_frame_ns += elapsed;
+        }
+    }
+
+    for (u32 i = 0; i < timer->commands_count; i += 1) {
+        GpuCommandTime& command = timer->commands[i];
+
+        if (command.last_frame_ns > 0) {
+            command.frames += 1;
+
+            if (command.last_frame_ns > command.max_frame_ns) {
+                command.max_frame_ns = command.last_frame_ns;
+            }
+        }
+    }
+
+    timer->last_frame_ns = frame_ns;
+    timer->frames_resolved += 1;
+}
+
+void gpu_timer_begin_frame(GpuTimer* timer) {
+    if (!timer->supported) {
+        return;
+    }
+
+    GpuTimerFrame& frame = timer->frames[timer->frame_index];
+
+    if (frame.pending) {
+        gpu_timer_resolve_frame(timer, frame);
+    }
+
+    frame.queries_count = 0;
+    frame.pending = false;
+}
+
+void gpu_timer_end_frame(GpuTimer* timer) {
+    if (!timer->supported) {
+        return;
+    }
+
+    assert(!timer->active);
+
+    timer->frames[timer->frame_index].pending = true;
+    timer->frame_index = (timer->frame_index + 1) % GPU_TIMER_FRAMES;
+}
+
+void gpu_timer_begin(GpuTimer* timer, u64 command_id) {
+    if (!timer->supported) {
+        return;
+    }
+
+    GpuTimerFrame& frame = timer->frames[timer->frame_index];
+
+    // NOTE: Draws beyond the capacity are not measured
+    if (frame.queries_count == GPU_TIMER_QUERIES_PER_FRAME) {
+        return;
+    }
+
+    assert(!timer->active);
+
+    GpuTimerQuery& query = frame.queries[frame.queries_count];
+    query.command_id = command_id;
+
+    glBeginQuery(GL_TIME_ELAPSED, query.id);
+    timer->active = true;
+}
+
+void gpu_timer_end(GpuTimer* timer) {
+    if (!timer->active) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    timer->active = false;
+    timer->frames[timer->frame_index].queries_count += 1;
+}
+
+void gpu_timer_reset_commands(GpuTimer* timer) {
+    timer->commands_count = 0;
+}
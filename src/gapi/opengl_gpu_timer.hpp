@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "primitives.hpp"
+
+// Results are read back this number of frames later to not stall on the GPU.
+static const u32 GPU_TIMER_FRAMES = 4;
+static const u32 GPU_TIMER_QUERIES_PER_FRAME = 256;
+static const u32 GPU_TIMER_COMMANDS_CAPACITY = 32;
+
+struct GpuTimerQuery {
+    GLuint id;
+    u64 command_id;
+};
+
+struct GpuTimerFrame {
+    GpuTimerQuery queries[GPU_TIMER_QUERIES_PER_FRAME];
+    u32 queries_count;
+    bool pending;
+};
+
+// GPU time aggregated for one command id since the last reset.
+struct GpuCommandTime {
+    u64 command_id;
+    u64 samples;
+    u64 frames;
+    u64 total_ns;
+    u64 max_frame_ns;
+    u64 last_frame_ns;
+};
+
+struct GpuTimer {
+    bool supported;
+    bool active;
+    u32 frame_index;
+    GpuTimerFrame frames[GPU_TIMER_FRAMES];
+
+    GpuCommandTime commands[GPU_TIMER_COMMANDS_CAPACITY];
+    u32 commands_count;
+
+    // GPU time of all queries in the last resolved frame
+    u64 last_frame_ns;
+    u64 frames_resolved;
+    u64 frames_dropped;
+};
+
+void gpu_timer_init(GpuTimer* timer);
+
+// Resolves queries of the frame issued GPU_TIMER_FRAMES ago and reuses them.
+void gpu_timer_begin_frame(GpuTimer* timer);
+
+void gpu_timer_end_frame(GpuTimer* timer);
+
+void gpu_timer_begin(GpuTimer* timer, u64 command_id);
+
+void gpu_timer_end(GpuTimer* timer);
+
+void gpu_timer_reset_commands(GpuTimer* timer);
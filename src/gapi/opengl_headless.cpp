@@ -0,0 +1,113 @@
+#include "gapi/opengl_headless.hpp"
+#include <EGL/eglext.h>
+
+Result<HeadlessContext> headless_create_context(int width, int height) {
+    HeadlessContext context = {
+        .display = EGL_NO_DISPLAY,
+        .context = EGL_NO_CONTEXT,
+        .framebuffer = 0,
+        .color_renderbuffer = 0,
+        .width = width,
+        .height = height,
+    };
+
+    // NOTE: Surfaceless platform works without a display server and a GPU (e.g. llvmpipe)
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (get_platform_display != nullptr) {
+        context.display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+
+    if (context.display == EGL_NO_DISPLAY) {
+        context.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (context.display == EGL_NO_DISPLAY || !eglInitialize(context.display, nullptr, nullptr)) {
+        return result_create_general_error<HeadlessContext>(
+            ErrorCode::GApiCreateContext,
+            "Can't initialize EGL display: 0x%x", eglGetError()
+        );
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        return result_create_general_error<HeadlessContext>(
+            ErrorCode::GApiCreateContext,
+            "Can't bind OpenGL API: 0x%x", eglGetError()
+        );
+    }
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configs_count = 0;
+
+    if (!eglChooseConfig(context.display, &config_attributes[0], &config, 1, &configs_count) || configs_count == 0) {
+        return result_create_general_error<HeadlessContext>(
+            ErrorCode::GApiCreateContext,
+            "Can't choose EGL config: 0x%x", eglGetError()
+        );
+    }
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 2,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    context.context = eglCreateContext(context.display, config, EGL_NO_CONTEXT, &context_attributes[0]);
+
+    if (context.context == EGL_NO_CONTEXT) {
+        return result_create_general_error<HeadlessContext>(
+            ErrorCode::GApiCreateContext,
+            "Can't create EGL context: 0x%x", eglGetError()
+        );
+    }
+
+    if (!eglMakeCurrent(context.display, EGL_NO_SURFACE, EGL_NO_SURFACE, context.context)) {
+        return result_create_general_error<HeadlessContext>(
+            ErrorCode::GApiCreateContext,
+            "Can't make EGL context current: 0x%x", eglGetError()
+        );
+    }
+
+    return result_create_success(context);
+}
+
+Result<bool> headless_create_framebuffer(HeadlessContext* context) {
+    glGenRenderbuffers(1, &context->color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, context->color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, context->width, context->height);
+
+    glGenFramebuffers(1, &context->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, context->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, context->color_renderbuffer);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        return result_create_general_error<bool>(
+            ErrorCode::GApiCreateContext,
+            "Offscreen framebuffer is incomplete: 0x%x", status
+        );
+    }
+
+    // NOTE: Stays bound for the whole lifetime of the context
+    glViewport(0, 0, context->width, context->height);
+    return result_create_success(true);
+}
+
+void headless_destroy_context(HeadlessContext context) {
+    if (context.framebuffer != 0) {
+        glDeleteFramebuffers(1, &context.framebuffer);
+        glDeleteRenderbuffers(1, &context.color_renderbuffer);
+    }
+
+    eglMakeCurrent(context.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(context.display, context.context);
+    eglTerminate(context.display);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include "primitives.hpp"
+
+// Offscreen OpenGL context without a window, rendering goes into a framebuffer object.
+struct HeadlessContext {
+    EGLDisplay display;
+    EGLContext context;
+    GLuint framebuffer;
+    GLuint color_renderbuffer;
+    int width;
+    int height;
+};
+
+// Creates EGL surfaceless context and makes it current.
+Result<HeadlessContext> headless_create_context(int width, int height);
+
+// Should be called after GL functions have been loaded.
+Result<bool> headless_create_framebuffer(HeadlessContext* context);
+
+void headless_destroy_context(HeadlessContext context);
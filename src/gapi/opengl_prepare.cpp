@@ -0,0 +1,213 @@
+#include "gapi/opengl_prepare.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include "vm.hpp"
+#include "vm_glm_adapter.hpp"
+
+struct PrepareJob {
+    PreparedFrame const* frame;
+    u64 first_element;
+    u64 elements_count;
+};
+
+BatchPrimitive prepared_command_primitive(u64 command_id) {
+    switch (command_id) {
+        case COMMAND_GAPI_DRAW_QUADS:
+            return BatchPrimitive::quads;
+
+        case COMMAND_GAPI_DRAW_CENTERED_QUADS:
+            return BatchPrimitive::centered_quads;
+
+        case COMMAND_GAPI_DRAW_LINES:
+        case COMMAND_GAPI_DRAW_PATH:
+            return BatchPrimitive::lines;
+
+        default:
+            return BatchPrimitive::none;
+    }
+}
+
+size_t prepared_element_size(BatchPrimitive primitive) {
+    switch (primitive) {
+        case BatchPrimitive::quads:
+        case BatchPrimitive::centered_quads:
+            return sizeof(QuadInstance);
+
+        case BatchPrimitive::lines:
+            return sizeof(LineVertex) * 2;
+
+        case BatchPrimitive::none:
+            return 0;
+    }
+
+    return 0;
+}
+
+bool prepared_command_init(PreparedCommand* command, CommandHeader const& header, Vec4f color) {
+    const BatchPrimitive primitive = prepared_command_primitive(header.id);
+
+    command->header = header;
+    command->primitive = BatchPrimitive::none;
+    command->color = color;
+    command->data = nullptr;
+    command->count = 0;
+    command->first_element = 0;
+
+    if (primitive == BatchPrimitive::lines) {
+        // NOTE: MVP, number of points and the points
+        if (header.size < sizeof(Mat4f) + sizeof(u64)) {
+            return false;
+        }
+
+        const u64 points = load_u64(header.payload + sizeof(Mat4f));
+
+        if (points > (header.size - sizeof(Mat4f) - sizeof(u64)) / sizeof(Vec2f)) {
+            return false;
+        }
+
+        // NOTE: GL_LINES ignores the last point of odd count
+        if (header.id == COMMAND_GAPI_DRAW_PATH) {
+            command->count = points > 0 ? points - 1 : 0;
+        }
+        else {
+            command->count = points / 2;
+        }
+    }
+    else if (primitive != BatchPrimitive::none) {
+        // NOTE: Number of quads and their MVPs
+        if (header.size < sizeof(u64)) {
+            return false;
+        }
+
+        const u64 quads = load_u64(header.payload);
+
+        if (quads > (header.size - sizeof(u64)) / sizeof(Mat4f)) {
+            return false;
+        }
+
+        command->count = quads;
+    }
+
+    command->primitive = primitive;
+    return true;
+}
+
+static void prepare_quads(PreparedCommand const* command, u64 first, u64 count) {
+    u8 const* matrices = command->header.payload + sizeof(u64);
+    QuadInstance* instances = (QuadInstance*) command->data;
+
+    for (u64 i = first; i < first + count; i += 1) {
+        memcpy(&instances[i].mvp, matrices + i * sizeof(Mat4f), sizeof(Mat4f));
+        instances[i].tex_rect = vm_vec4f(0.f, 0.f, 1.f, 1.f);
+        instances[i].color = command->color;
+    }
+}
+
+static void prepare_lines(PreparedCommand const* command, u64 first, u64 count) {
+    const auto mvp = glm_mat4(load_mat4f(command->header.payload));
+    u8 const* points = command->header.payload + sizeof(Mat4f) + sizeof(u64);
+    LineVertex* vertices = (LineVertex*) command->data;
+
+    // NOTE: Path segments share points, separate lines don't
+    const u64 stride = command->header.id == COMMAND_GAPI_DRAW_PATH ? 1 : 2;
+
+    for (u64 i = first; i < first + count; i += 1) {
+        const u64 point = i * stride;
+
+        vertices[i * 2].position = transform_point(mvp, load_vec2f(points + point * sizeof(Vec2f)));
+        vertices[i * 2].color = command->color;
+        vertices[i * 2 + 1].position = transform_point(mvp, load_vec2f(points + (point + 1) * sizeof(Vec2f)));
+        vertices[i * 2 + 1].color = command->color;
+    }
+}
+
+// Returns the last command which first element isn't after the given one.
+static u64 prepared_frame_find_command(PreparedFrame const* frame, u64 element) {
+    u64 low = 0;
+    u64 high = frame->commands_count;
+
+    while (high - low > 1) {
+        const u64 middle = low + (high - low) / 2;
+
+        if (frame->commands[middle].first_element <= element) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+static void prepare_elements(PreparedFrame const* frame, u64 first_element, u64 elements_count) {
+    u64 element = first_element;
+    const u64 end = first_element + elements_count;
+
+    for (u64 i = prepared_frame_find_command(frame, element); i < frame->commands_count && element < end; i += 1) {
+        PreparedCommand const* command = &frame->commands[i];
+
+        if (command->data == nullptr || command->first_element + command->count <= element) {
+            continue;
+        }
+
+        const u64 first = element - command->first_element;
+        const u64 last = end - command->first_element < command->count ? end - command->first_element : command->count;
+
+        if (command->primitive == BatchPrimitive::lines) {
+            prepare_lines(command, first, last - first);
+        }
+        else {
+            prepare_quads(command, first, last - first);
+        }
+
+        element = command->first_element + last;
+    }
+}
+
+static void prepare_job(void* data) {
+    PROFILE_ZONE("prepare_job");
+    auto job = (PrepareJob const*) data;
+    prepare_elements(job->frame, job->first_element, job->elements_count);
+}
+
+void prepared_frame_expand(PreparedFrame* frame, FrameAllocator* frame_allocator) {
+    PROFILE_FUNCTION();
+
+    if (frame->elements_count < GAPI_PREPARE_MIN_ELEMENTS || job_system_get_workers_count() == 0) {
+        prepare_elements(frame, 0, frame->elements_count);
+        return;
+    }
+
+    const u64 jobs_count = (frame->elements_count + GAPI_PREPARE_JOB_ELEMENTS - 1) / GAPI_PREPARE_JOB_ELEMENTS;
+    const auto prepare_jobs_result = frame_push<PrepareJob>(frame_allocator, jobs_count);
+    const auto jobs_result = frame_push<Job>(frame_allocator, jobs_count);
+
+    if (result_has_error(prepare_jobs_result) || result_has_error(jobs_result)) {
+        prepare_elements(frame, 0, frame->elements_count);
+        return;
+    }
+
+    PrepareJob* prepare_jobs = result_get_payload(prepare_jobs_result);
+    Job* jobs = result_get_payload(jobs_result);
+
+    for (u64 i = 0; i < jobs_count; i += 1) {
+        const u64 first_element = i * GAPI_PREPARE_JOB_ELEMENTS;
+        const u64 left = frame->elements_count - first_element;
+
+        prepare_jobs[i] = {
+            .frame = frame,
+            .first_element = first_element,
+            .elements_count = left < GAPI_PREPARE_JOB_ELEMENTS ? left : GAPI_PREPARE_JOB_ELEMENTS,
+        };
+
+        jobs[i] = {
+            .function = prepare_job,
+            .data = &prepare_jobs[i],
+        };
+    }
+
+    JobCounter counter;
+    job_system_submit(jobs, (u32) jobs_count, &counter);
+    job_system_wait(&counter);
+}
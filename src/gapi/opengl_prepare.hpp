@@ -0,0 +1,50 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "frame_allocator.hpp"
+#include "gapi/opengl.hpp"
+#include "gapi/commands.hpp"
+#include <glm/glm.hpp>
+
+// Draws are expanded on the worker threads only when the frame has at least
+// this number of quads and line segments, otherwise jobs don't pay off.
+static const u64 GAPI_PREPARE_MIN_ELEMENTS = 4096;
+
+// Number of quads or line segments expanded by one job
+static const u64 GAPI_PREPARE_JOB_ELEMENTS = 2048;
+
+// Command with its draw expanded into GPU-ready data ahead of submission.
+struct PreparedCommand {
+    CommandHeader header;
+    // none when the command is executed by its handler during submission
+    BatchPrimitive primitive;
+    // Pipeline color at the moment of the draw
+    Vec4f color;
+    // QuadInstance per quad or two LineVertex per line segment
+    u8* data;
+    u64 count;
+    // Index of the first element among all elements of the frame
+    u64 first_element;
+};
+
+struct PreparedFrame {
+    PreparedCommand* commands;
+    u64 commands_count;
+    u64 elements_count;
+};
+
+static inline Vec4f transform_point(glm::mat4 const& mvp, Vec2f point) {
+    const auto result = mvp * glm::vec4(point.x, point.y, 0.0f, 1.0f);
+    return vm_vec4f(result.x, result.y, result.z, result.w);
+}
+
+// Returns primitive of draw commands that can be prepared, none for the rest.
+BatchPrimitive prepared_command_primitive(u64 command_id);
+
+size_t prepared_element_size(BatchPrimitive primitive);
+
+// Reads number of elements of the draw, returns false if it doesn't fit into the payload.
+bool prepared_command_init(PreparedCommand* command, CommandHeader const& header, Vec4f color);
+
+// Expands all draws of the frame, on the worker threads when it's worth it.
+void prepared_frame_expand(PreparedFrame* frame, FrameAllocator* frame_allocator);
@@ -1,7 +1,56 @@
 #include "gapi/opengl_sdl2.hpp"
 #include "platform.hpp"
 
+#ifdef GAPI_HEADLESS
+
+static Result<GApiContext> gapi_create_headless_context(Window window) {
+    auto headless_context_result = headless_create_context(window.width, window.height);
+
+    if (result_has_error(headless_context_result)) {
+        return switch_error<GApiContext>(headless_context_result);
+    }
+
+    GApiContext gapi_context = {
+        .gl_context = nullptr,
+        .headless = true,
+        .headless_context = result_get_payload(headless_context_result),
+    };
+
+    // NOTE: GLEW built with GLX can't find GLX display, but GL functions are loaded anyway
+    const auto glew_status = glewInit();
+
+    if (glew_status != GLEW_OK && glew_status != GLEW_ERROR_NO_GLX_DISPLAY) {
+        return result_create_general_error<GApiContext>(
+            ErrorCode::GApiInit,
+            "glewInit() error"
+        );
+    }
+
+    auto framebuffer_result = headless_create_framebuffer(&gapi_context.headless_context);
+
+    if (result_has_error(framebuffer_result)) {
+        return switch_error<GApiContext>(framebuffer_result);
+    }
+
+    return result_create_success(gapi_context);
+}
+
+#else
+
+static Result<GApiContext> gapi_create_headless_context(Window window) {
+    return result_create_general_error<GApiContext>(
+        ErrorCode::GApiCreateContext,
+        "Headless mode isn't supported, build with HEADLESS=1"
+    );
+}
+
+#endif
+
 Result<GApiContext> gapi_create_context(Platform& platform, Window window) {
+    if (window.headless) {
+        return gapi_create_headless_context(window);
+    }
+
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -28,16 +77,63 @@ Result<GApiContext> gapi_create_context(Platform& platform, Window window) {
     }
 
     GApiContext gapiContext = {
-        .gl_context = gl_context
+        .gl_context = gl_context,
+        .headless = false,
     };
 
     return result_create_success(gapiContext);
 }
 
 void gapi_swap_window(Platform& platform, Window window) {
+    if (window.headless) {
+        // NOTE: There is nothing to present, but the frame should be finished like with a real swap
+        glFlush();
+        return;
+    }
+
     SDL_GL_SwapWindow(window.sdl_window);
 }
 
+Result<bool> gapi_read_frame(Window& window, u8* dest, size_t size) {
+    int width;
+    int height;
+
+    platform_get_window_size(window, &width, &height);
+
+    const size_t row_size = (size_t) width * 4;
+
+    if (size < row_size * height) {
+        return result_create_general_error<bool>(
+            ErrorCode::GApiReadFrame,
+            "Frame of %dx%d doesn't fit into %zu bytes", width, height, size
+        );
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, dest);
+
+    // NOTE: GL rows go from bottom to top
+    for (int y = 0; y < height / 2; y += 1) {
+        u8* top = dest + row_size * y;
+        u8* bottom = dest + row_size * (height - 1 - y);
+
+        for (size_t x = 0; x < row_size; x += 1) {
+            const u8 pixel = top[x];
+            top[x] = bottom[x];
+            bottom[x] = pixel;
+        }
+    }
+
+    return result_create_success(true);
+}
+
 void gapi_shutdown(GApiContext context) {
+#ifdef GAPI_HEADLESS
+    if (context.headless) {
+        headless_destroy_context(context.headless_context);
+        return;
+    }
+#endif
+
     SDL_GL_DeleteContext(context.gl_context);
 }
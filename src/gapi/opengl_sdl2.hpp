@@ -2,6 +2,14 @@
 
 #include <SDL2/SDL.h>
 
+#ifdef GAPI_HEADLESS
+#include "gapi/opengl_headless.hpp"
+#endif
+
 struct GApiContext {
     SDL_GLContext gl_context;
+    bool headless;
+#ifdef GAPI_HEADLESS
+    HeadlessContext headless_context;
+#endif
 };
@@ -0,0 +1,135 @@
+#include "gapi/opengl_state.hpp"
+
+void gl_state_reset(GLState* state) {
+    state->program = GL_STATE_UNKNOWN;
+    state->vertex_array = GL_STATE_UNKNOWN;
+    state->array_buffer = GL_STATE_UNKNOWN;
+    state->active_texture = GL_STATE_UNKNOWN;
+
+    for (u32 i = 0; i < GL_STATE_TEXTURE_UNITS; i += 1) {
+        state->textures[i] = GL_STATE_UNKNOWN;
+    }
+
+    state->viewport[0] = -1;
+    state->viewport[1] = -1;
+    state->viewport[2] = -1;
+    state->viewport[3] = -1;
+
+    state->uniforms_count = 0;
+}
+
+void gl_state_use_program(GLState* state, GLuint program) {
+    if (state->program == program) {
+        state->elided_calls += 1;
+        return;
+    }
+
+    glUseProgram(program);
+    state->program = program;
+    state->calls += 1;
+}
+
+void gl_state_bind_vertex_array(GLState* state, GLuint vertex_array) {
+    if (state->vertex_array == vertex_array) {
+        state->elided_calls += 1;
+        return;
+    }
+
+    glBindVertexArray(vertex_array);
+    state->vertex_array = vertex_array;
+    state->calls += 1;
+}
+
+void gl_state_bind_array_buffer(GLState* state, GLuint buffer) {
+    if (state->array_buffer == buffer) {
+        state->elided_calls += 1;
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    state->array_buffer = buffer;
+    state->calls += 1;
+}
+
+static void gl_state_active_texture(GLState* state, u32 unit) {
+    if (state->active_texture == unit) {
+        state->elided_calls += 1;
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    state->active_texture = unit;
+    state->calls += 1;
+}
+
+void gl_state_bind_texture(GLState* state, u32 unit, GLuint texture) {
+    assert(unit < GL_STATE_TEXTURE_UNITS);
+
+    if (state->textures[unit] == texture) {
+        state->elided_calls += 1;
+        return;
+    }
+
+    gl_state_active_texture(state, unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    state->textures[unit] = texture;
+    state->calls += 1;
+}
+
+void gl_state_delete_texture(GLState* state, GLuint texture) {
+    glDeleteTextures(1, &texture);
+
+    // NOTE: GL unbinds deleted texture from all units
+    for (u32 i = 0; i < GL_STATE_TEXTURE_UNITS; i += 1) {
+        if (state->textures[i] == texture) {
+            state->textures[i] = 0;
+        }
+    }
+}
+
+void gl_state_viewport(GLState* state, GLint x, GLint y, GLint width, GLint height) {
+    if (state->viewport[0] == x && state->viewport[1] == y &&
+        state->viewport[2] == width && state->viewport[3] == height)
+    {
+        state->elided_calls += 1;
+        return;
+    }
+
+    glViewport(x, y, width, height);
+    state->viewport[0] = x;
+    state->viewport[1] = y;
+    state->viewport[2] = width;
+    state->viewport[3] = height;
+    state->calls += 1;
+}
+
+void gl_state_uniform_1i(GLState* state, GLint location, GLint value) {
+    for (u32 i = 0; i < state->uniforms_count; i += 1) {
+        GLStateUniform& uniform = state->uniforms[i];
+
+        if (uniform.program == state->program && uniform.location == location) {
+            if (uniform.value == value) {
+                state->elided_calls += 1;
+                return;
+            }
+
+            glUniform1i(location, value);
+            uniform.value = value;
+            state->calls += 1;
+            return;
+        }
+    }
+
+    glUniform1i(location, value);
+    state->calls += 1;
+
+    // NOTE: When the cache is full the uniform is just not cached
+    if (state->uniforms_count < GL_STATE_UNIFORMS_CAPACITY) {
+        state->uniforms[state->uniforms_count] = {
+            .program = state->program,
+            .location = location,
+            .value = value,
+        };
+        state->uniforms_count += 1;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "primitives.hpp"
+
+static const u32 GL_STATE_TEXTURE_UNITS = 8;
+static const u32 GL_STATE_UNIFORMS_CAPACITY = 16;
+
+// NOTE: Value of cached state that is unknown, e.g. after initialization
+static const GLuint GL_STATE_UNKNOWN = ~0u;
+
+struct GLStateUniform {
+    GLuint program;
+    GLint location;
+    GLint value;
+};
+
+// Shadow copy of the GL state, used to skip calls that don't change anything.
+// NOTE: Element array buffer binding is a part of VAO state, so it's set once
+// when VAO is created and isn't tracked here.
+struct GLState {
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    u32 active_texture;
+    GLuint textures[GL_STATE_TEXTURE_UNITS];
+    GLint viewport[4];
+
+    GLStateUniform uniforms[GL_STATE_UNIFORMS_CAPACITY];
+    u32 uniforms_count;
+
+    u64 calls;
+    u64 elided_calls;
+};
+
+// Forgets all cached state, next calls will go to GL unconditionally.
+void gl_state_reset(GLState* state);
+
+void gl_state_use_program(GLState* state, GLuint program);
+
+void gl_state_bind_vertex_array(GLState* state, GLuint vertex_array);
+
+void gl_state_bind_array_buffer(GLState* state, GLuint buffer);
+
+void gl_state_bind_texture(GLState* state, u32 unit, GLuint texture);
+
+void gl_state_delete_texture(GLState* state, GLuint texture);
+
+void gl_state_viewport(GLState* state, GLint x, GLint y, GLint width, GLint height);
+
+// Sets sampler or int uniform of the current program.
+void gl_state_uniform_1i(GLState* state, GLint location, GLint value);
@@ -0,0 +1,109 @@
+#include "gapi/opengl_stream_buffer.hpp"
+
+// NOTE: 1 second, if the GPU is slower than that something is terribly wrong
+static const GLuint64 STREAM_BUFFER_FENCE_TIMEOUT = 1000000000;
+
+Result<bool> stream_buffer_init(StreamBuffer* buffer, RegionMemoryBuffer* memory, size_t frame_size) {
+    *buffer = {};
+    buffer->frame_size = frame_size;
+    buffer->persistent = GLEW_ARB_buffer_storage;
+
+    const size_t size = frame_size * STREAM_BUFFER_FRAMES;
+
+    glGenBuffers(1, &buffer->id);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer->id);
+
+    if (buffer->persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        buffer->mapped = (u8*) glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+
+        if (buffer->mapped == nullptr) {
+            return result_create_general_error<bool>(
+                ErrorCode::GApiInit,
+                "Failed to map stream buffer of size %zu", size
+            );
+        }
+    }
+    else {
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        const auto staging_result = region_memory_buffer_alloc_aligned(memory, frame_size, MEMORY_CACHE_LINE_SIZE);
+
+        if (result_has_error(staging_result)) {
+            return switch_error<bool>(staging_result);
+        }
+
+        buffer->staging = result_get_payload(staging_result);
+    }
+
+    return result_create_success(true);
+}
+
+static void wait_fence(GLsync* fence) {
+    if (*fence == nullptr) {
+        return;
+    }
+
+    GLenum status = glClientWaitSync(*fence, 0, 0);
+
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_BUFFER_FENCE_TIMEOUT);
+    }
+
+    if (status == GL_WAIT_FAILED) {
+        log_error("Failed to wait for stream buffer fence");
+    }
+
+    glDeleteSync(*fence);
+    *fence = nullptr;
+}
+
+void stream_buffer_begin_frame(StreamBuffer* buffer) {
+    buffer->frame_index = (buffer->frame_index + 1) % STREAM_BUFFER_FRAMES;
+
+    if (buffer->persistent) {
+        wait_fence(&buffer->fences[buffer->frame_index]);
+    }
+}
+
+void stream_buffer_end_frame(StreamBuffer* buffer) {
+    if (buffer->persistent) {
+        buffer->fences[buffer->frame_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void stream_buffer_restart_frame(StreamBuffer* buffer) {
+    if (buffer->persistent) {
+        stream_buffer_end_frame(buffer);
+        wait_fence(&buffer->fences[buffer->frame_index]);
+    }
+}
+
+u8* stream_buffer_frame_data(StreamBuffer* buffer) {
+    if (buffer->persistent) {
+        return buffer->mapped + stream_buffer_frame_offset(buffer);
+    }
+    else {
+        return buffer->staging;
+    }
+}
+
+size_t stream_buffer_frame_offset(StreamBuffer* buffer) {
+    return buffer->frame_size * buffer->frame_index;
+}
+
+void stream_buffer_flush(StreamBuffer* buffer, GLState* state, size_t offset, size_t size) {
+    // NOTE: Persistent mapping is coherent, nothing to do
+    if (buffer->persistent) {
+        return;
+    }
+
+    gl_state_bind_array_buffer(state, buffer->id);
+    glBufferSubData(
+        GL_ARRAY_BUFFER,
+        stream_buffer_frame_offset(buffer) + offset,
+        size,
+        buffer->staging + offset
+    );
+}
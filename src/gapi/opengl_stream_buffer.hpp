@@ -0,0 +1,45 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "primitives.hpp"
+#include "memory.hpp"
+#include "gapi/opengl_state.hpp"
+
+// NOTE: Number of frames the GPU can lag behind the CPU
+static const u32 STREAM_BUFFER_FRAMES = 3;
+
+// Ring buffer of STREAM_BUFFER_FRAMES sections, one section per frame.
+// When ARB_buffer_storage is available the whole buffer is persistently
+// mapped and data is written directly into GPU visible memory, sections
+// are guarded by fences. Otherwise data goes into CPU staging memory and
+// is uploaded with glBufferSubData.
+struct StreamBuffer {
+    GLuint id;
+    size_t frame_size;
+    u32 frame_index;
+    bool persistent;
+    u8* mapped;
+    u8* staging;
+    GLsync fences[STREAM_BUFFER_FRAMES];
+};
+
+Result<bool> stream_buffer_init(StreamBuffer* buffer, RegionMemoryBuffer* memory, size_t frame_size);
+
+// Switches to the next section, waits until the GPU is done with it.
+void stream_buffer_begin_frame(StreamBuffer* buffer);
+
+// Protects the current section with a fence.
+void stream_buffer_end_frame(StreamBuffer* buffer);
+
+// Waits until the GPU is done with the current section so it can be
+// overwritten from the beginning, used when a frame doesn't fit into it.
+void stream_buffer_restart_frame(StreamBuffer* buffer);
+
+// Memory of the current section to write data into.
+u8* stream_buffer_frame_data(StreamBuffer* buffer);
+
+// Offset of the current section in the GL buffer.
+size_t stream_buffer_frame_offset(StreamBuffer* buffer);
+
+// Makes written range of the current section visible to the GPU.
+void stream_buffer_flush(StreamBuffer* buffer, GLState* state, size_t offset, size_t size);
@@ -0,0 +1,226 @@
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+struct JobEntry {
+    Job job;
+    JobCounter* counter;
+};
+
+// NOTE: Owner takes jobs from the back, thieves from the front
+struct JobQueue {
+    std::mutex mutex;
+    JobEntry entries[JOB_QUEUE_CAPACITY];
+    u32 head;
+    u32 count;
+};
+
+struct JobSystem {
+    std::thread workers[JOB_SYSTEM_MAX_WORKERS];
+    u32 workers_count;
+    // NOTE: Queue 0 belongs to the thread that waits for jobs, the rest to the workers
+    JobQueue queues[JOB_SYSTEM_MAX_WORKERS + 1];
+    std::atomic<u32> next_queue;
+    std::atomic<u32> queued;
+    std::atomic<bool> running;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+};
+
+static JobSystem job_system;
+static thread_local u32 job_thread_queue = 0;
+
+static bool job_queue_push(JobQueue* queue, JobEntry const& entry) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    if (queue->count == JOB_QUEUE_CAPACITY) {
+        return false;
+    }
+
+    queue->entries[(queue->head + queue->count) % JOB_QUEUE_CAPACITY] = entry;
+    queue->count += 1;
+
+    return true;
+}
+
+static bool job_queue_pop(JobQueue* queue, JobEntry* entry) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    if (queue->count == 0) {
+        return false;
+    }
+
+    queue->count -= 1;
+    *entry = queue->entries[(queue->head + queue->count) % JOB_QUEUE_CAPACITY];
+
+    return true;
+}
+
+static bool job_queue_steal(JobQueue* queue, JobEntry* entry) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    if (queue->count == 0) {
+        return false;
+    }
+
+    *entry = queue->entries[queue->head];
+    queue->head = (queue->head + 1) % JOB_QUEUE_CAPACITY;
+    queue->count -= 1;
+
+    return true;
+}
+
+static bool job_system_find_job(u32 queue_index, JobEntry* entry) {
+    const u32 queues_count = job_system.workers_count + 1;
+
+    if (job_queue_pop(&job_system.queues[queue_index], entry)) {
+        job_system.queued.fetch_sub(1);
+        return true;
+    }
+
+    for (u32 i = 1; i < queues_count; i += 1) {
+        if (job_queue_steal(&job_system.queues[(queue_index + i) % queues_count], entry)) {
+            job_system.queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void job_system_run(JobEntry const& entry) {
+    entry.job.function(entry.job.data);
+    entry.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+static void job_system_worker(u32 queue_index) {
+    job_thread_queue = queue_index;
+
+    while (job_system.running.load()) {
+        JobEntry entry;
+
+        if (job_system_find_job(queue_index, &entry)) {
+            job_system_run(entry);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(job_system.wake_mutex);
+        job_system.wake.wait(lock, []() {
+            return job_system.queued.load() > 0 || !job_system.running.load();
+        });
+    }
+}
+
+static void job_system_stop(u32 started_workers) {
+    {
+        std::lock_guard<std::mutex> lock(job_system.wake_mutex);
+        job_system.running = false;
+    }
+
+    job_system.wake.notify_all();
+
+    for (u32 i = 0; i < started_workers; i += 1) {
+        job_system.workers[i].join();
+    }
+
+    job_system.workers_count = 0;
+}
+
+Result<bool> job_system_init(int workers_count) {
+    if (workers_count == 0) {
+        const u32 cores = std::thread::hardware_concurrency();
+        workers_count = cores > 1 ? (int) cores - 1 : 0;
+    }
+
+    if (workers_count < 0) {
+        workers_count = 0;
+    }
+
+    if (workers_count > (int) JOB_SYSTEM_MAX_WORKERS) {
+        workers_count = JOB_SYSTEM_MAX_WORKERS;
+    }
+
+    // NOTE: Workers scan queues up to workers_count, so it is set before they start
+    job_system.workers_count = workers_count;
+    job_system.running = true;
+
+    for (int i = 0; i < workers_count; i += 1) {
+        try {
+            job_system.workers[i] = std::thread(job_system_worker, (u32) i + 1);
+        }
+        catch (std::system_error const& error) {
+            job_system_stop(i);
+
+            return result_create_general_error<bool>(
+                ErrorCode::JobSystemInit,
+                "Can't start worker thread: %s", error.what()
+            );
+        }
+    }
+
+    return result_create_success(true);
+}
+
+void job_system_shutdown() {
+    job_system_stop(job_system.workers_count);
+}
+
+u32 job_system_get_workers_count() {
+    return job_system.workers_count;
+}
+
+void job_system_submit(Job const* jobs, u32 count, JobCounter* counter) {
+    const u32 queues_count = job_system.workers_count + 1;
+    u32 pushed = 0;
+
+    counter->pending.fetch_add(count);
+
+    for (u32 i = 0; i < count; i += 1) {
+        const JobEntry entry = {
+            .job = jobs[i],
+            .counter = counter,
+        };
+
+        const u32 queue_index = job_system.next_queue.fetch_add(1) % queues_count;
+
+        // NOTE: Counted before the push, so it never gets below the number of queued jobs
+        job_system.queued.fetch_add(1);
+
+        if (job_queue_push(&job_system.queues[queue_index], entry)) {
+            pushed += 1;
+        }
+        else {
+            job_system.queued.fetch_sub(1);
+            job_system_run(entry);
+        }
+    }
+
+    if (pushed == 0 || job_system.workers_count == 0) {
+        return;
+    }
+
+    {
+        // NOTE: Locked to not miss workers that are about to wait
+        std::lock_guard<std::mutex> lock(job_system.wake_mutex);
+    }
+
+    job_system.wake.notify_all();
+}
+
+void job_system_wait(JobCounter* counter) {
+    PROFILE_FUNCTION();
+
+    while (counter->pending.load(std::memory_order_acquire) > 0) {
+        JobEntry entry;
+
+        if (job_system_find_job(job_thread_queue, &entry)) {
+            job_system_run(entry);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include "primitives.hpp"
+
+typedef void (*JobFunction)(void* data);
+
+struct Job {
+    JobFunction function;
+    void* data;
+};
+
+// Number of submitted jobs that haven't finished yet.
+struct JobCounter {
+    std::atomic<u32> pending { 0 };
+};
+
+static const u32 JOB_SYSTEM_MAX_WORKERS = 31;
+
+// NOTE: Jobs that don't fit into the queue run on the submitting thread
+static const u32 JOB_QUEUE_CAPACITY = 512;
+
+// Starts worker threads, 0 starts one per core except the calling thread,
+// negative doesn't start any and jobs run on the thread that waits for them.
+Result<bool> job_system_init(int workers_count);
+
+void job_system_shutdown();
+
+u32 job_system_get_workers_count();
+
+// Jobs are spread over the queues of all threads, threads that run out of
+// jobs steal them from the queues of the others.
+void job_system_submit(Job const* jobs, u32 count, JobCounter* counter);
+
+// Runs jobs on the calling thread until all jobs of the counter are done.
+void job_system_wait(JobCounter* counter);
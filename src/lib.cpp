@@ -2,39 +2,99 @@
 #include "shell.hpp"
 #include "vm.hpp"
 #include "log.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include "asset_loader.hpp"
+#include "texture_registry.hpp"
 
 extern "C" void sdl2shell_run(ShellConfig config) {
-    auto platform_init_result = platform_init();
+    if (config.size != sizeof(ShellConfig)) {
+        log_error("ShellConfig size is %u, expected %u, the host should be rebuilt with this shell_config.hpp", config.size, (u32) sizeof(ShellConfig));
+        return;
+    }
+
+    // NOTE: Set before anything is allocated
+    platform_set_huge_pages((PlatformHugePages) config.huge_pages);
+
+    auto job_system_result = job_system_init(config.worker_threads);
+
+    // NOTE: Without workers jobs run on the main thread, so it isn't fatal
+    if (result_has_error(job_system_result)) {
+        log_error(job_system_result.error.message);
+    }
+
+    auto asset_loader_result = asset_loader_init(config);
+
+    // NOTE: Without loader threads assets are decoded on the main thread
+    if (result_has_error(asset_loader_result)) {
+        log_error(asset_loader_result.error.message);
+    }
+
+    auto platform_init_result = platform_init(config);
 
     if (result_is_success(platform_init_result)) {
         auto platform = result_get_payload(platform_init_result);
-        auto create_window_result = platform_create_window(config, platform);
+        auto shell_state_result = shell_init(config);
 
-        if (result_is_success(create_window_result)) {
-            auto window = result_get_payload(create_window_result);
-            bool running = true;
-            auto shell_state_result = shell_init(config);
+        if (result_is_success(shell_state_result)) {
+            auto shell_state = result_get_payload(shell_state_result);
+            // NOTE: Shell is initialized first, shaders and fonts of the GAPI are loaded into its assets memory
+            auto create_window_result = platform_create_window(config, platform, &shell_state.memory.assets_buffer);
 
-            if (result_is_success(shell_state_result)) {
-                auto shell_state = result_get_payload(shell_state_result);
+            if (result_is_success(create_window_result)) {
+                auto window = result_get_payload(create_window_result);
+                bool running = true;
 
-                while (running) {
-                    running = platform_event_loop(platform, window);
-                    shell_main_loop(shell_state, platform, window);
+                gapi_set_frame_allocator(platform.gapi, &shell_state.memory.frame_allocator);
+                texture_registry_init();
+                auto texture_registry_result = texture_registry_register_commands(platform.gapi);
+
+                // NOTE: Without the handlers texture commands are skipped, the rest still works
+                if (result_has_error(texture_registry_result)) {
+                    log_error(texture_registry_result.error.message);
                 }
+
+                if (config.replay_path != nullptr) {
+                    shell_replay(shell_state, platform, window);
+                }
+                else {
+                    platform.recorder = shell_state.recording ? &shell_state.recorder : nullptr;
+
+                    while (running) {
+                        running = platform_event_loop(platform, window);
+                        shell_main_loop(shell_state, platform, window);
+                        running = running && !shell_state.finished;
+                    }
+                }
+
+                shell_shutdown(shell_state, platform);
+                texture_registry_shutdown(platform.gapi);
+                platform_destroy_window(window);
+                log_info("Successfully finished");
             }
             else {
                 log_error(create_window_result.error.message);
             }
-
-            platform_destroy_window(window);
-            log_info("Successfully finished");
         }
         else {
-            log_error(create_window_result.error.message);
+            log_error(shell_state_result.error.message);
         }
     }
     else {
         log_error(platform_init_result.error.message);
     }
+
+    asset_loader_shutdown();
+    job_system_shutdown();
+
+#ifdef PROFILE
+    // NOTE: Exported after all threads are joined, their buffers aren't synchronized
+    if (config.profile_trace_path != nullptr) {
+        const auto export_result = profiler_export_chrome_trace(config.profile_trace_path);
+
+        if (result_has_error(export_result)) {
+            log_error(export_result.error.message);
+        }
+    }
+#endif
 }
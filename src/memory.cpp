@@ -1,112 +1,514 @@
 #include "memory.hpp"
 #include "platform.hpp"
+#include "log.hpp"
+#include "memory_tracking.hpp"
 
-Result<RegionMemoryBuffer> create_region_memory_buffer(u64 size) {
-    u8* base = platform_alloc(size);
+static u64 memory_round_up_to_page(u64 size) {
+    const u64 page_size = platform_get_page_size();
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+// Address space reserved for a root region of the given size.
+static u64 region_memory_reserved_size(u64 size) {
+#ifdef MEMORY_GUARD
+    // NOTE: Page after the region is never committed, so overruns crash
+    return memory_round_up_to_page(size) + platform_get_page_size();
+#else
+    return size;
+#endif
+}
+
+static Result<RegionMemoryBuffer> create_root_region(u64 size, bool commit_all) {
+    const u64 reserved_size = region_memory_reserved_size(size);
+    u8* base = commit_all ? platform_alloc(reserved_size) : platform_reserve(reserved_size);
 
     if (base) {
         auto buffer = RegionMemoryBuffer {
             .base = base,
             .size = size,
             .offset = 0,
+            .high_water = 0,
+            .committed = commit_all ? size : 0,
         };
         return result_create_success<RegionMemoryBuffer>(buffer);
     }
     else {
         return result_create_general_error<RegionMemoryBuffer>(
             ErrorCode::Allocation,
-            "platform_alloc has failed"
+            "platform_reserve has failed"
         );
     }
 }
 
+Result<RegionMemoryBuffer> create_region_memory_buffer(u64 size) {
+#ifdef MEMORY_GUARD
+    // NOTE: Huge pages can't be protected one by one, so guards are always on regular pages
+    const bool commit_all = false;
+#else
+    // NOTE: Explicit huge pages are taken from the pool on allocation, so they are committed up front
+    const bool commit_all = platform_get_huge_pages() == PlatformHugePages::explicit_pages;
+#endif
+    return create_root_region(size, commit_all);
+}
+
+Result<RegionMemoryBuffer> create_reserved_region_memory_buffer(u64 size) {
+    return create_root_region(size, false);
+}
+
+// Commits memory of the region up to the offset.
+static bool region_memory_buffer_commit(RegionMemoryBuffer* buffer, u64 offset) {
+    if (offset <= buffer->committed) {
+        return true;
+    }
+
+    u64 committed = (offset + MEMORY_COMMIT_GRANULARITY - 1) & ~(MEMORY_COMMIT_GRANULARITY - 1);
+
+    if (committed > buffer->size) {
+        committed = buffer->size;
+    }
+
+    if (!platform_commit(buffer->base + buffer->committed, committed - buffer->committed)) {
+        return false;
+    }
+
+    buffer->committed = committed;
+    return true;
+}
+
+// Reserves a block and puts its header at the beginning.
+static Result<RegionMemoryBuffer> create_region_memory_block(RegionMemoryBlock* previous, u64 size, bool reserved) {
+    auto block_result = reserved ? create_reserved_region_memory_buffer(size) : create_region_memory_buffer(size);
+
+    if (result_has_error(block_result)) {
+        return block_result;
+    }
+
+    auto block = result_get_payload(block_result);
+    // NOTE: Headers aren't charged to the tag of the allocation that has created the block
+    MEMORY_TAG("memory/block_headers");
+    const auto header_result = region_push<RegionMemoryBlock>(&block, 1);
+
+    if (result_has_error(header_result)) {
+        platform_free(block.base, region_memory_reserved_size(block.size));
+        return switch_error<RegionMemoryBuffer>(header_result);
+    }
+
+    RegionMemoryBlock* header = result_get_payload(header_result);
+    header->previous = previous;
+    header->size = size;
+
+    return result_create_success(block);
+}
+
+static Result<GrowableRegionMemoryBuffer> create_growable_region(u64 block_size, u64 budget, bool reserved) {
+    assert(block_size > sizeof(RegionMemoryBlock));
+
+    budget = (budget + block_size - 1) / block_size * block_size;
+
+    const auto block_result = create_region_memory_block(nullptr, block_size, reserved);
+
+    if (result_has_error(block_result)) {
+        return switch_error<GrowableRegionMemoryBuffer>(block_result);
+    }
+
+    const auto block = result_get_payload(block_result);
+
+    GrowableRegionMemoryBuffer buffer = {
+        .current = block,
+        .first = block,
+        .blocks = (RegionMemoryBlock*) block.base,
+        .blocks_count = 1,
+        .block_size = block_size,
+        .budget = budget,
+        .capacity = block_size,
+        .used_before = 0,
+        .high_water = block.offset,
+        .reserved = reserved,
+    };
+
+    return result_create_success(buffer);
+}
+
+Result<GrowableRegionMemoryBuffer> create_growable_region_memory_buffer(u64 block_size, u64 budget) {
+    return create_growable_region(block_size, budget, false);
+}
+
+Result<GrowableRegionMemoryBuffer> create_reserved_growable_region_memory_buffer(u64 block_size, u64 budget) {
+    return create_growable_region(block_size, budget, true);
+}
+
 Result<StackMemoryBuffer> create_stack_memory_buffer(RegionMemoryBuffer* root, u64 size) {
-    StackMemoryBuffer buffer;
+    const auto base_result = region_memory_buffer_alloc_aligned(root, size, MEMORY_CACHE_LINE_SIZE);
 
-    if (root->offset + size > root->size) {
-        return result_create_general_error<StackMemoryBuffer>(
-            ErrorCode::Allocation,
-            "Out of memory"
-        );
+    if (result_has_error(base_result)) {
+        return switch_error<StackMemoryBuffer>(base_result);
     }
 
-    root->offset += size;
+    StackMemoryBuffer buffer = {
+        .base = result_get_payload(base_result),
+        .size = size,
+        .offset = 0,
+        .high_water = 0,
+    };
+
     return result_create_success(buffer);
 }
 
-Result<ArenaMemoryBuffer> create_arena_memory_buffer(RegionMemoryBuffer* where, u64 count, u64 chunk_size) {
-    const u64 full_chunk_size = chunk_size + sizeof(Arena);
-    Result<u8*> base_result = region_memory_buffer_alloc(where, count * full_chunk_size);
+Result<PoolMemoryBuffer> create_pool_memory_buffer(RegionMemoryBuffer* root, u64 blocks_count, u64 block_size) {
+    static_assert(sizeof(PoolBlock) <= MEMORY_DEFAULT_ALIGNMENT, "Free list link should fit into a block");
+
+    block_size = (block_size + MEMORY_DEFAULT_ALIGNMENT - 1) & ~(MEMORY_DEFAULT_ALIGNMENT - 1);
+
+    if (block_size == 0) {
+        block_size = MEMORY_DEFAULT_ALIGNMENT;
+    }
+
+    const auto base_result = region_memory_buffer_alloc_aligned(root, blocks_count * block_size, MEMORY_CACHE_LINE_SIZE);
 
     if (result_has_error(base_result)) {
-        return switch_error<ArenaMemoryBuffer>(base_result);
+        return switch_error<PoolMemoryBuffer>(base_result);
     }
-    else {
-        u8* base = result_unwrap(base_result);
-        ArenaMemoryBuffer buffer;
-        buffer.head = (Arena*) base;
-        Arena* current = buffer.head;
-
-        for (size_t i = 1; i < count; ++i) {
-            current->next = (Arena*) (base + (i * full_chunk_size));
-            current = current->next;
-        }
 
-        current->next = nullptr;
-        return result_create_success(buffer);
+    PoolMemoryBuffer buffer = {
+        .base = result_get_payload(base_result),
+        .block_size = block_size,
+        .blocks_count = blocks_count,
+        .used_count = 0,
+        .high_water = 0,
+        .free_list = nullptr,
+        .allocated = nullptr,
+    };
+
+#ifdef VALIDATE
+    const auto allocated_result = region_push<u8>(root, blocks_count);
+
+    if (result_has_error(allocated_result)) {
+        return switch_error<PoolMemoryBuffer>(allocated_result);
     }
+
+    buffer.allocated = result_get_payload(allocated_result);
+    memset(buffer.allocated, 0, blocks_count);
+    memset(buffer.base, MEMORY_POISON_FREE, blocks_count * block_size);
+#endif
+
+    // NOTE: Linked backwards, so blocks are handed out from the beginning
+    for (u64 i = blocks_count; i > 0; i -= 1) {
+        auto block = (PoolBlock*) (buffer.base + (i - 1) * block_size);
+        block->next = buffer.free_list;
+        buffer.free_list = block;
+    }
+
+    return result_create_success(buffer);
+}
+
+u64 region_memory_buffer_sub_region_size(u64 size) {
+#ifdef MEMORY_GUARD
+    return memory_round_up_to_page(size) + platform_get_page_size() * 2;
+#else
+    return size + MEMORY_CACHE_LINE_SIZE;
+#endif
 }
 
 void region_memory_buffer_add_region(RegionMemoryBuffer* where, RegionMemoryBuffer* buffer, u64 size) {
-    assert(where->offset + size <= where->size);
+#ifdef MEMORY_GUARD
+    // NOTE: Sub-regions start at a page and are followed by an inaccessible page
+    const u64 page_size = platform_get_page_size();
+    u8* base = align_pointer(where->base + where->offset, page_size);
+    const u64 guard_offset = (u64) (align_pointer(base + size, page_size) - where->base);
+    const u64 offset = guard_offset + page_size;
+#else
+    u8* base = align_pointer(where->base + where->offset, MEMORY_CACHE_LINE_SIZE);
+    const u64 offset = (u64) (base - where->base) + size;
+#endif
+
+    assert(offset <= where->size);
+    MEMORY_TRACK_ALLOC(where->base, where->size, size);
 
-    buffer->base = where->base + where->offset;
+    buffer->base = base;
     buffer->size = size;
     buffer->offset = 0;
+    buffer->high_water = 0;
+    buffer->committed = size;
+
+    // NOTE: Allocations from the sub-region fail instead of accessing memory that isn't committed
+    if (!region_memory_buffer_commit(where, offset)) {
+        log_error("Can't commit %llu bytes of memory", (unsigned long long) size);
+        buffer->size = 0;
+        buffer->committed = 0;
+    }
+#ifdef MEMORY_GUARD
+    else if (!platform_protect_pages(where->base + guard_offset, page_size)) {
+        log_error("Can't protect guard page of memory region");
+    }
+#endif
 
-    where->offset += size;
+    where->offset = offset;
+    where->high_water = where->offset > where->high_water ? where->offset : where->high_water;
 }
 
 Result<u8*> region_memory_buffer_alloc(RegionMemoryBuffer* buffer, u64 size) {
+    return region_memory_buffer_alloc_aligned(buffer, size, MEMORY_DEFAULT_ALIGNMENT);
+}
+
+Result<u8*> region_memory_buffer_alloc_aligned(RegionMemoryBuffer* buffer, u64 size, u64 alignment) {
     assert(buffer != nullptr);
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
 
-    if (buffer->offset + size > buffer->size) {
+    // NOTE: Base of a region isn't necessarily aligned, so the address is aligned, not the offset
+    u8* result = align_pointer(buffer->base + buffer->offset, alignment);
+    const u64 offset = (u64) (result - buffer->base) + size;
+
+    if (offset > buffer->size) {
         return result_create_general_error<u8*>(
             ErrorCode::Allocation,
-            "Out of memory"
+            "Out of memory: %llu bytes are requested, %llu of %llu bytes are used",
+            (unsigned long long) size,
+            (unsigned long long) buffer->offset,
+            (unsigned long long) buffer->size
         );
     }
 
-    // TODO: Alignment
-    u8* result = buffer->base + buffer->offset;
-    buffer->offset += size;
+    if (!region_memory_buffer_commit(buffer, offset)) {
+        return result_create_general_error<u8*>(
+            ErrorCode::Allocation,
+            "Can't commit memory"
+        );
+    }
+
+    buffer->offset = offset;
 
+    if (buffer->offset > buffer->high_water) {
+        buffer->high_water = buffer->offset;
+    }
+
+    MEMORY_TRACK_ALLOC(buffer->base, buffer->size, size);
     return result_create_success(result);
 }
 
 void region_memory_buffer_free(RegionMemoryBuffer* buffer) {
     buffer->offset = 0;
+    MEMORY_TRACK_RESET(buffer->base, buffer->size);
 }
 
-Result<Arena*> arena_memory_buffer_alloc(ArenaMemoryBuffer* buffer) {
+MemoryUsage region_memory_buffer_get_usage(RegionMemoryBuffer const* buffer) {
+    return {
+        .used = buffer->offset,
+        .high_water = buffer->high_water,
+        .capacity = buffer->size,
+    };
+}
+
+Result<u8*> growable_region_memory_buffer_alloc(GrowableRegionMemoryBuffer* buffer, u64 size) {
+    return growable_region_memory_buffer_alloc_aligned(buffer, size, MEMORY_DEFAULT_ALIGNMENT);
+}
+
+Result<u8*> growable_region_memory_buffer_alloc_aligned(GrowableRegionMemoryBuffer* buffer, u64 size, u64 alignment) {
+    assert(alignment <= MEMORY_CACHE_LINE_SIZE);
+
+    // NOTE: Fails only when the current block is full, the error is dropped then
+    if (buffer->current.offset + alignment + size <= buffer->current.size) {
+        const auto data_result = region_memory_buffer_alloc_aligned(&buffer->current, size, alignment);
+
+        if (result_is_success(data_result)) {
+            const u64 used = buffer->used_before + buffer->current.offset;
+            buffer->high_water = used > buffer->high_water ? used : buffer->high_water;
+        }
+
+        return data_result;
+    }
+
+    // NOTE: Allocations bigger than a block get a block of their own
+    const u64 required = sizeof(RegionMemoryBlock) + alignment + size;
+    const u64 block_size = required > buffer->block_size ? required : buffer->block_size;
+
+    if (buffer->capacity + block_size > buffer->budget) {
+        return result_create_general_error<u8*>(
+            ErrorCode::Allocation,
+            "Memory budget of %llu bytes is exceeded, %llu bytes are requested",
+            (unsigned long long) buffer->budget,
+            (unsigned long long) size
+        );
+    }
+
+    const auto block_result = create_region_memory_block(buffer->blocks, block_size, buffer->reserved);
+
+    if (result_has_error(block_result)) {
+        return switch_error<u8*>(block_result);
+    }
+
+    // NOTE: Keeps commit state of the first block, it's reused after the region is freed
+    if (buffer->blocks_count == 1) {
+        buffer->first = buffer->current;
+    }
+
+    buffer->used_before += buffer->current.offset;
+    buffer->current = result_get_payload(block_result);
+    buffer->blocks = (RegionMemoryBlock*) buffer->current.base;
+    buffer->blocks_count += 1;
+    buffer->capacity += block_size;
+
+    return growable_region_memory_buffer_alloc_aligned(buffer, size, alignment);
+}
+
+void growable_region_memory_buffer_free(GrowableRegionMemoryBuffer* buffer) {
+    RegionMemoryBlock* block = buffer->blocks;
+
+    while (block->previous != nullptr) {
+        RegionMemoryBlock* previous = block->previous;
+        MEMORY_TRACK_RESET(block, block->size);
+        platform_free((u8*) block, region_memory_reserved_size(block->size));
+        block = previous;
+    }
+
+    MEMORY_TRACK_RESET(block, block->size);
+
+    if (buffer->blocks_count > 1) {
+        buffer->current = buffer->first;
+    }
+
+    // NOTE: Header of the first block is kept
+    buffer->current.offset = sizeof(RegionMemoryBlock);
+    buffer->blocks = block;
+    buffer->blocks_count = 1;
+    buffer->capacity = block->size;
+    buffer->used_before = 0;
+}
+
+void growable_region_memory_buffer_destroy(GrowableRegionMemoryBuffer* buffer) {
+    growable_region_memory_buffer_free(buffer);
+
+    // NOTE: Only the first block is left after free
+    RegionMemoryBlock* block = buffer->blocks;
+    platform_free((u8*) block, region_memory_reserved_size(block->size));
+
+    buffer->blocks = nullptr;
+    buffer->blocks_count = 0;
+    buffer->capacity = 0;
+}
+
+MemoryUsage growable_region_memory_buffer_get_usage(GrowableRegionMemoryBuffer const* buffer) {
+    return {
+        .used = buffer->used_before + buffer->current.offset,
+        .high_water = buffer->high_water,
+        .capacity = buffer->capacity,
+    };
+}
+
+void region_memory_buffer_release(RegionMemoryBuffer* buffer, u64 keep_size) {
+    buffer->offset = 0;
+    MEMORY_TRACK_RESET(buffer->base, buffer->size);
+
+    // NOTE: Pages after the high water have never been touched
+    if (buffer->high_water > keep_size) {
+        platform_release_pages(buffer->base + keep_size, buffer->high_water - keep_size);
+    }
+}
+
+Result<u8*> stack_memory_buffer_alloc(StackMemoryBuffer* buffer, u64 size) {
+    return stack_memory_buffer_alloc_aligned(buffer, size, MEMORY_DEFAULT_ALIGNMENT);
+}
+
+Result<u8*> stack_memory_buffer_alloc_aligned(StackMemoryBuffer* buffer, u64 size, u64 alignment) {
     assert(buffer != nullptr);
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    u8* result = align_pointer(buffer->base + buffer->offset, alignment);
+    const u64 offset = (u64) (result - buffer->base) + size;
 
-    if (buffer->head == nullptr) {
-        return result_create_general_error<Arena*>(
+    if (offset > buffer->size) {
+        return result_create_general_error<u8*>(
             ErrorCode::Allocation,
             "Out of memory"
         );
     }
-    else {
-        Arena* arena = buffer->head->next;
-        return result_create_success(arena);
+
+    buffer->offset = offset;
+
+    if (buffer->offset > buffer->high_water) {
+        buffer->high_water = buffer->offset;
+    }
+
+    return result_create_success(result);
+}
+
+StackMarker stack_memory_buffer_get_marker(StackMemoryBuffer* buffer) {
+    return StackMarker { .offset = buffer->offset };
+}
+
+void stack_memory_buffer_rollback(StackMemoryBuffer* buffer, StackMarker marker) {
+    assert(marker.offset <= buffer->offset);
+
+#ifdef VALIDATE
+    memset(buffer->base + marker.offset, MEMORY_POISON_FREE, buffer->offset - marker.offset);
+#endif
+
+    buffer->offset = marker.offset;
+}
+
+#ifdef VALIDATE
+static bool pool_block_is_poisoned(PoolMemoryBuffer* buffer, u8* block) {
+    for (u64 i = sizeof(PoolBlock); i < buffer->block_size; i += 1) {
+        if (block[i] != MEMORY_POISON_FREE) {
+            return false;
+        }
     }
+
+    return true;
 }
+#endif
 
-void arena_memory_buffer_free(ArenaMemoryBuffer* buffer, Arena* arena) {
+Result<u8*> pool_memory_buffer_alloc(PoolMemoryBuffer* buffer) {
     assert(buffer != nullptr);
-    assert(arena != nullptr);
 
-    arena->next = buffer->head;
-    buffer->head = arena;
+    PoolBlock* block = buffer->free_list;
+
+    if (block == nullptr) {
+        return result_create_general_error<u8*>(
+            ErrorCode::Allocation,
+            "Pool of %llu blocks of %llu bytes is out of blocks",
+            (unsigned long long) buffer->blocks_count,
+            (unsigned long long) buffer->block_size
+        );
+    }
+
+    buffer->free_list = block->next;
+    buffer->used_count += 1;
+
+    if (buffer->used_count > buffer->high_water) {
+        buffer->high_water = buffer->used_count;
+    }
+
+#ifdef VALIDATE
+    const u64 index = ((u8*) block - buffer->base) / buffer->block_size;
+
+    // NOTE: Poison is broken when a block is written after it has been freed
+    assert(pool_block_is_poisoned(buffer, (u8*) block) && "Pool block is modified after free");
+    assert(!buffer->allocated[index]);
+
+    buffer->allocated[index] = 1;
+    memset(block, MEMORY_POISON_ALLOCATED, buffer->block_size);
+#endif
+
+    return result_create_success((u8*) block);
+}
+
+void pool_memory_buffer_free(PoolMemoryBuffer* buffer, u8* block) {
+    assert(buffer != nullptr);
+    assert(block != nullptr);
+    assert(block >= buffer->base && block < buffer->base + buffer->blocks_count * buffer->block_size);
+    assert((u64) (block - buffer->base) % buffer->block_size == 0);
+
+#ifdef VALIDATE
+    const u64 index = (block - buffer->base) / buffer->block_size;
+
+    assert(buffer->allocated[index] && "Double free of pool block");
+
+    buffer->allocated[index] = 0;
+    memset(block, MEMORY_POISON_FREE, buffer->block_size);
+#endif
+
+    auto free_block = (PoolBlock*) block;
+    free_block->next = buffer->free_list;
+    buffer->free_list = free_block;
+    buffer->used_count -= 1;
 }
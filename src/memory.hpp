@@ -4,49 +4,186 @@
 #include "primitives.hpp"
 #include <glm/glm.hpp>
 
+// NOTE: Enough for any scalar and SSE type
+static const u64 MEMORY_DEFAULT_ALIGNMENT = 16;
+static const u64 MEMORY_CACHE_LINE_SIZE = 64;
+
+// Reserved memory of root regions is committed by chunks of this size
+static const u64 MEMORY_COMMIT_GRANULARITY = megabytes(2);
+
 struct RegionMemoryBuffer {
     u8* base;
     u64 size;
     size_t offset;
+    // Max offset since creation
+    size_t high_water;
+    // NOTE: Sub-regions are committed by the parent region as a whole
+    u64 committed;
 };
 
 struct StackMemoryBuffer {
     u8* base;
     u64 size;
     size_t offset;
+    // Max offset since creation
+    size_t high_water;
+};
+
+// Header at the beginning of every block of a growable region.
+struct RegionMemoryBlock {
+    RegionMemoryBlock* previous;
+    u64 size;
+};
+
+// Region that reserves a new block from the platform when the current one is full,
+// as long as all blocks together fit into the budget.
+struct GrowableRegionMemoryBuffer {
+    // Block allocations are taken from
+    RegionMemoryBuffer current;
+    // NOTE: Updated only when the first block is left
+    RegionMemoryBuffer first;
+    // Header of the current block, previous ones are linked through it
+    RegionMemoryBlock* blocks;
+    u32 blocks_count;
+    u64 block_size;
+    u64 budget;
+    // Reserved size of all blocks
+    u64 capacity;
+    // Bytes used in the blocks before the current one
+    u64 used_before;
+    // Max used bytes since creation
+    u64 high_water;
+    // NOTE: Blocks aren't committed up front even with explicit huge pages
+    bool reserved;
+};
+
+struct MemoryUsage {
+    u64 used;
+    u64 high_water;
+    u64 capacity;
+};
+
+// Position of the stack to roll back to.
+struct StackMarker {
+    size_t offset;
 };
 
-struct Arena {
-    u8* data;
-    Arena* next;
+struct PoolBlock {
+    PoolBlock* next;
 };
 
-struct ArenaMemoryBuffer {
-    Arena* head;
+// Blocks of the same size linked into a free list through the free blocks.
+// With VALIDATE free blocks are poisoned and double frees are detected.
+struct PoolMemoryBuffer {
+    u8* base;
+    u64 block_size;
+    u64 blocks_count;
+    u64 used_count;
+    // Max used blocks since creation
+    u64 high_water;
+    PoolBlock* free_list;
+    // NOTE: Allocated flag per block, only with VALIDATE
+    u8* allocated;
 };
 
+static const u8 MEMORY_POISON_FREE = 0xDD;
+static const u8 MEMORY_POISON_ALLOCATED = 0xCD;
+
 // API
+// Reserves address space of the given size, memory is committed as the region grows.
 Result<RegionMemoryBuffer> create_region_memory_buffer(u64 size);
 
+// Same as create_region_memory_buffer, but memory is committed as the region grows
+// even with explicit huge pages, for regions that are mostly empty.
+Result<RegionMemoryBuffer> create_reserved_region_memory_buffer(u64 size);
+
+// Budget is rounded up to the block size.
+Result<GrowableRegionMemoryBuffer> create_growable_region_memory_buffer(u64 block_size, u64 budget);
+
+// Growable region of reserved blocks, see create_reserved_region_memory_buffer.
+Result<GrowableRegionMemoryBuffer> create_reserved_growable_region_memory_buffer(u64 block_size, u64 budget);
+
 Result<StackMemoryBuffer> create_stack_memory_buffer(RegionMemoryBuffer* root, u64 size);
 
-Result<ArenaMemoryBuffer> create_arena_memory_buffer(RegionMemoryBuffer* root, u64 size, u64 chunkSize);
+// Block size is rounded up to MEMORY_DEFAULT_ALIGNMENT.
+Result<PoolMemoryBuffer> create_pool_memory_buffer(RegionMemoryBuffer* root, u64 blocks_count, u64 block_size);
+
+// Size a sub-region takes from its parent, including alignment and guard pages.
+u64 region_memory_buffer_sub_region_size(u64 size);
 
+// Sub-regions start at a cache line, so they don't share lines with each other.
+// With MEMORY_GUARD they are separated by inaccessible pages.
 void region_memory_buffer_add_region(RegionMemoryBuffer* where, RegionMemoryBuffer* buffer, u64 size);
 
+// Returns memory aligned to MEMORY_DEFAULT_ALIGNMENT.
 Result<u8*> region_memory_buffer_alloc(RegionMemoryBuffer* buffer, u64 size);
 
+// Alignment should be a power of two.
+Result<u8*> region_memory_buffer_alloc_aligned(RegionMemoryBuffer* buffer, u64 size, u64 alignment);
+
 void region_memory_buffer_free(RegionMemoryBuffer* buffer);
 
-Result<Arena*> arena_memory_buffer_alloc(ArenaMemoryBuffer* buffer);
+// Frees the region and returns its pages after the first keep_size bytes to the OS,
+// they stay committed and read as zeros.
+void region_memory_buffer_release(RegionMemoryBuffer* buffer, u64 keep_size);
+
+MemoryUsage region_memory_buffer_get_usage(RegionMemoryBuffer const* buffer);
 
-void arena_memory_buffer_free(ArenaMemoryBuffer* buffer, Arena* arena);
+// Returns memory aligned to MEMORY_DEFAULT_ALIGNMENT.
+Result<u8*> growable_region_memory_buffer_alloc(GrowableRegionMemoryBuffer* buffer, u64 size);
+
+// Alignment should be a power of two not bigger than MEMORY_CACHE_LINE_SIZE.
+Result<u8*> growable_region_memory_buffer_alloc_aligned(GrowableRegionMemoryBuffer* buffer, u64 size, u64 alignment);
+
+// Returns all blocks except the first one to the platform.
+void growable_region_memory_buffer_free(GrowableRegionMemoryBuffer* buffer);
+
+// Returns all blocks to the platform, the region can't be used after that.
+void growable_region_memory_buffer_destroy(GrowableRegionMemoryBuffer* buffer);
+
+MemoryUsage growable_region_memory_buffer_get_usage(GrowableRegionMemoryBuffer const* buffer);
+
+// Returns memory aligned to MEMORY_DEFAULT_ALIGNMENT.
+Result<u8*> stack_memory_buffer_alloc(StackMemoryBuffer* buffer, u64 size);
+
+// Alignment should be a power of two.
+Result<u8*> stack_memory_buffer_alloc_aligned(StackMemoryBuffer* buffer, u64 size, u64 alignment);
+
+StackMarker stack_memory_buffer_get_marker(StackMemoryBuffer* buffer);
+
+// Frees everything allocated after the marker was taken.
+void stack_memory_buffer_rollback(StackMemoryBuffer* buffer, StackMarker marker);
+
+Result<u8*> pool_memory_buffer_alloc(PoolMemoryBuffer* buffer);
+
+void pool_memory_buffer_free(PoolMemoryBuffer* buffer, u8* block);
 
 Result<bool> init_memory();
 
+static inline u8* align_pointer(u8* pointer, u64 alignment) {
+    return (u8*) (((umm) pointer + alignment - 1) & ~((umm) alignment - 1));
+}
+
+// Budget of ShellConfig in megabytes, values below 1 mean the default size.
+static inline u64 memory_budget(int budget_mb, u64 default_size) {
+    return budget_mb > 0 ? (u64) megabytes(budget_mb) : default_size;
+}
+
+// Allocates uninitialized array of count elements aligned to alignof(T).
+template<typename T>
+Result<T*> region_push(RegionMemoryBuffer* buffer, u64 count) {
+    auto data_result = region_memory_buffer_alloc_aligned(buffer, sizeof(T) * count, alignof(T));
+
+    if (result_has_error(data_result)) {
+        return switch_error<T*>(data_result);
+    }
+
+    return result_create_success((T*) result_get_payload(data_result));
+}
+
 template<typename T>
 Result<u8*> region_memory_push_struct(RegionMemoryBuffer* buffer, T data) {
-    auto dataResult = region_memory_buffer_alloc(buffer, sizeof(T));
+    auto dataResult = region_memory_buffer_alloc_aligned(buffer, sizeof(T), alignof(T));
 
     if (result_is_success(dataResult)) {
         auto base = result_get_payload(dataResult);
@@ -58,7 +195,7 @@ Result<u8*> region_memory_push_struct(RegionMemoryBuffer* buffer, T data) {
 
 template<typename T>
 Result<u8*> region_memory_push_chunk(RegionMemoryBuffer* buffer, T* data, size_t len) {
-    auto dataResult = region_memory_buffer_alloc(buffer, sizeof(T) * len);
+    auto dataResult = region_memory_buffer_alloc_aligned(buffer, sizeof(T) * len, alignof(T));
 
     if (result_is_success(dataResult)) {
         auto base = result_get_payload(dataResult);
@@ -0,0 +1,170 @@
+#include "memory_tracking.hpp"
+#include <algorithm>
+#include <mutex>
+
+struct MemoryTagStats {
+    MemoryTag const* tag;
+    u64 allocations;
+    u64 bytes;
+    u64 live_bytes;
+    u64 peak_bytes;
+};
+
+// Live bytes of a tag in a region, to free them when the region is reset.
+struct MemoryTrackingEntry {
+    MemoryTagStats* stats;
+    void const* region_base;
+    u64 region_size;
+    u64 live_bytes;
+};
+
+struct MemoryTracking {
+    std::mutex mutex;
+    MemoryTagStats tags[MEMORY_TRACKING_TAGS_CAPACITY];
+    size_t tags_count;
+    MemoryTrackingEntry entries[MEMORY_TRACKING_ENTRIES_CAPACITY];
+    size_t entries_count;
+    // Allocations that didn't fit into the tables
+    u64 dropped;
+};
+
+static const MemoryTag memory_untagged = { "untagged", "", 0 };
+
+static MemoryTracking memory_tracking;
+static thread_local MemoryTag const* memory_current_tag = nullptr;
+
+MemoryTagScope::MemoryTagScope(MemoryTag const* tag) : previous(memory_current_tag) {
+    memory_current_tag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope() {
+    memory_current_tag = previous;
+}
+
+static MemoryTagStats* memory_tracking_find_tag(MemoryTag const* tag) {
+    for (size_t i = 0; i < memory_tracking.tags_count; i += 1) {
+        if (memory_tracking.tags[i].tag == tag) {
+            return &memory_tracking.tags[i];
+        }
+    }
+
+    if (memory_tracking.tags_count == MEMORY_TRACKING_TAGS_CAPACITY) {
+        return nullptr;
+    }
+
+    MemoryTagStats* stats = &memory_tracking.tags[memory_tracking.tags_count];
+    memory_tracking.tags_count += 1;
+
+    *stats = {};
+    stats->tag = tag;
+
+    return stats;
+}
+
+static MemoryTrackingEntry* memory_tracking_find_entry(MemoryTagStats* stats, void const* region_base, u64 region_size) {
+    for (size_t i = 0; i < memory_tracking.entries_count; i += 1) {
+        MemoryTrackingEntry* entry = &memory_tracking.entries[i];
+
+        if (entry->stats == stats && entry->region_base == region_base && entry->region_size == region_size) {
+            return entry;
+        }
+    }
+
+    if (memory_tracking.entries_count == MEMORY_TRACKING_ENTRIES_CAPACITY) {
+        return nullptr;
+    }
+
+    MemoryTrackingEntry* entry = &memory_tracking.entries[memory_tracking.entries_count];
+    memory_tracking.entries_count += 1;
+
+    entry->stats = stats;
+    entry->region_base = region_base;
+    entry->region_size = region_size;
+    entry->live_bytes = 0;
+
+    return entry;
+}
+
+void memory_tracking_alloc(void const* region_base, u64 region_size, u64 size) {
+    MemoryTag const* tag = memory_current_tag != nullptr ? memory_current_tag : &memory_untagged;
+    std::lock_guard<std::mutex> lock(memory_tracking.mutex);
+
+    MemoryTagStats* stats = memory_tracking_find_tag(tag);
+    MemoryTrackingEntry* entry = stats != nullptr ? memory_tracking_find_entry(stats, region_base, region_size) : nullptr;
+
+    if (entry == nullptr) {
+        memory_tracking.dropped += 1;
+        return;
+    }
+
+    entry->live_bytes += size;
+    stats->allocations += 1;
+    stats->bytes += size;
+    stats->live_bytes += size;
+
+    if (stats->live_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->live_bytes;
+    }
+}
+
+void memory_tracking_reset(void const* region_base, u64 region_size) {
+    std::lock_guard<std::mutex> lock(memory_tracking.mutex);
+
+    for (size_t i = 0; i < memory_tracking.entries_count; i += 1) {
+        MemoryTrackingEntry* entry = &memory_tracking.entries[i];
+
+        if (entry->region_base == region_base && entry->region_size == region_size) {
+            entry->stats->live_bytes -= entry->live_bytes;
+            entry->live_bytes = 0;
+        }
+    }
+}
+
+u64 memory_tracking_get_live_bytes(const char* category) {
+    std::lock_guard<std::mutex> lock(memory_tracking.mutex);
+    u64 live_bytes = 0;
+
+    // NOTE: Every MEMORY_TAG call site is a tag of its own, they can share the category
+    for (size_t i = 0; i < memory_tracking.tags_count; i += 1) {
+        if (strcmp(memory_tracking.tags[i].tag->category, category) == 0) {
+            live_bytes += memory_tracking.tags[i].live_bytes;
+        }
+    }
+
+    return live_bytes;
+}
+
+void memory_tracking_log_report() {
+    std::lock_guard<std::mutex> lock(memory_tracking.mutex);
+
+    MemoryTagStats const* sorted[MEMORY_TRACKING_TAGS_CAPACITY];
+
+    for (size_t i = 0; i < memory_tracking.tags_count; i += 1) {
+        sorted[i] = &memory_tracking.tags[i];
+    }
+
+    std::sort(&sorted[0], &sorted[memory_tracking.tags_count], [](MemoryTagStats const* a, MemoryTagStats const* b) {
+        return a->peak_bytes > b->peak_bytes;
+    });
+
+    printf("Memory allocations by tag (peak / live / total bytes, allocations):\n");
+
+    for (size_t i = 0; i < memory_tracking.tags_count; i += 1) {
+        MemoryTagStats const* stats = sorted[i];
+
+        printf(
+            "  %-24s %12llu %12llu %12llu %8llu  %s:%u\n",
+            stats->tag->category,
+            (unsigned long long) stats->peak_bytes,
+            (unsigned long long) stats->live_bytes,
+            (unsigned long long) stats->bytes,
+            (unsigned long long) stats->allocations,
+            stats->tag->file,
+            stats->tag->line
+        );
+    }
+
+    if (memory_tracking.dropped > 0) {
+        printf("  %llu allocations are not tracked, tables are full\n", (unsigned long long) memory_tracking.dropped);
+    }
+}
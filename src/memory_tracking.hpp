@@ -0,0 +1,55 @@
+#pragma once
+
+#include "primitives.hpp"
+
+// Static description of an allocation site, one per MEMORY_TAG call site.
+struct MemoryTag {
+    const char* category;
+    const char* file;
+    u32 line;
+};
+
+// Max number of tags and of (tag, region) pairs, allocations beyond them aren't tracked.
+static const size_t MEMORY_TRACKING_TAGS_CAPACITY = 256;
+static const size_t MEMORY_TRACKING_ENTRIES_CAPACITY = 1024;
+
+// Allocations made while the scope is alive are tracked under its tag, the innermost wins.
+struct MemoryTagScope {
+    MemoryTag const* previous;
+
+    MemoryTagScope(MemoryTag const* tag);
+    ~MemoryTagScope();
+};
+
+// Region is identified by its base and size, as the first sub-region shares the base with its parent.
+// Allocations without a tag are tracked as "untagged".
+void memory_tracking_alloc(void const* region_base, u64 region_size, u64 size);
+
+// All allocations of the region are freed.
+void memory_tracking_reset(void const* region_base, u64 region_size);
+
+// Live bytes of all tags of the category, 0 when nothing is tracked under it.
+u64 memory_tracking_get_live_bytes(const char* category);
+
+// Prints allocations, live and peak bytes per tag, sorted by peak.
+void memory_tracking_log_report();
+
+#ifdef MEMORY_TRACKING
+
+#define MEMORY_TAG(category_name) \
+    static const MemoryTag MEMORY_TAG_CONCAT(memory_tag_, __LINE__) = { category_name, __FILE__, __LINE__ }; \
+    MemoryTagScope MEMORY_TAG_CONCAT(memory_tag_scope_, __LINE__)(&MEMORY_TAG_CONCAT(memory_tag_, __LINE__))
+
+#define MEMORY_TRACK_ALLOC(region_base, region_size, size) memory_tracking_alloc(region_base, region_size, size)
+#define MEMORY_TRACK_RESET(region_base, region_size) memory_tracking_reset(region_base, region_size)
+
+#else
+
+#define MEMORY_TAG(category_name)
+#define MEMORY_TRACK_ALLOC(region_base, region_size, size)
+#define MEMORY_TRACK_RESET(region_base, region_size)
+
+#endif
+
+#define MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_IMPL(a, b)
@@ -20,19 +20,38 @@ struct Window;
 
 struct Font;
 
-Result<Platform> platform_init();
+// Input sent to the VM, also recorded for replay.
+struct InputEvent {
+    u64 command_id;
+    u8 button;
+    // NOTE: Width and height for COMMAND_UPDATE_VIEWPORT
+    i32 x;
+    i32 y;
+};
+
+Result<Platform> platform_init(ShellConfig const& config);
 
 extern "C" Vec2f platform_get_mouse_state();
 
-Result<Window> platform_create_window(ShellConfig const& config, Platform& platform);
+// Initializes the GAPI, its shaders and fonts are loaded into assets_memory.
+Result<Window> platform_create_window(ShellConfig const& config, Platform& platform, GrowableRegionMemoryBuffer* assets_memory);
 
-Result<AssetData> platform_load_font(ShellConfig const& config, RegionMemoryBuffer* dest_memory, const char* asset_name);
+Result<AssetData> platform_load_font(ShellConfig const& config, GrowableRegionMemoryBuffer* dest_memory, const char* asset_name);
 
 bool platform_event_loop(Platform& platform, Window& window);
 
+void platform_push_input_event(InputEvent const& event);
+
+void platform_wait_events(Platform& platform, u32 timeout_ms);
+
+bool platform_consume_window_damage(Window& window);
+
 void platform_get_window_size(Window& window, int* width, int* height);
 
-float platform_get_ticks();
+// High resolution time in milliseconds
+f64 platform_get_ticks();
+
+void platform_sleep(f64 milliseconds);
 
 void platform_swap_window(Platform& platform, Window& window);
 
@@ -40,8 +59,41 @@ void platform_destroy_window(Window& window);
 
 void platform_shutdown(Platform& platform);
 
+enum class PlatformHugePages {
+    none,
+    // Transparent huge pages requested with madvise, the kernel may ignore it
+    transparent,
+    // Explicit huge pages from the pool configured in the system, allocations
+    // fall back to regular pages when the pool is exhausted
+    explicit_pages,
+};
+
+// Applies to memory allocated or reserved after the call.
+void platform_set_huge_pages(PlatformHugePages mode);
+
+PlatformHugePages platform_get_huge_pages();
+
+MemoryIndex platform_get_page_size();
+
+// Returns zeroed memory, pages are backed lazily when they are touched.
 u8* platform_alloc(MemoryIndex size);
 
+// Frees memory of platform_alloc and platform_reserve.
+void platform_free(u8* base, MemoryIndex size);
+
+// Reserves address space without memory, it can't be accessed until committed.
+u8* platform_reserve(MemoryIndex size);
+
+// Makes the page aligned range of reserved memory accessible, pages read as zeros
+// and are backed with memory when they are touched.
+bool platform_commit(u8* base, MemoryIndex size);
+
+// Returns whole pages of the range to the OS, memory stays accessible and reads as zeros.
+void platform_release_pages(u8* base, MemoryIndex size);
+
+// Makes the page aligned range inaccessible, any access to it crashes.
+bool platform_protect_pages(u8* base, MemoryIndex size);
+
 const char platform_preffered_path_separator =
 #ifdef _WIN32
     '\\';
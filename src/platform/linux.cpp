@@ -1,16 +1,99 @@
 #include "platform.hpp"
+#include <errno.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 
+// NOTE: Default size of MAP_HUGETLB pages on x86-64 and arm64
+static const MemoryIndex LINUX_HUGE_PAGE_SIZE = megabytes(2);
+
+static PlatformHugePages linux_huge_pages = PlatformHugePages::none;
+
+static MemoryIndex linux_round_up(MemoryIndex size, MemoryIndex alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static void linux_advise_huge_pages(void* base, MemoryIndex size) {
+#ifdef MADV_HUGEPAGE
+    if (linux_huge_pages == PlatformHugePages::transparent && size >= LINUX_HUGE_PAGE_SIZE) {
+        madvise(base, size, MADV_HUGEPAGE);
+    }
+#endif
+}
+
+void platform_set_huge_pages(PlatformHugePages mode) {
+    linux_huge_pages = mode;
+}
+
+PlatformHugePages platform_get_huge_pages() {
+    return linux_huge_pages;
+}
+
+MemoryIndex platform_get_page_size() {
+    static const MemoryIndex page_size = (MemoryIndex) sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
 u8* platform_alloc(MemoryIndex size) {
+#ifdef MAP_HUGETLB
+    if (linux_huge_pages == PlatformHugePages::explicit_pages && size >= LINUX_HUGE_PAGE_SIZE) {
+        // NOTE: Without MAP_NORESERVE pages are taken from the pool right away,
+        // so an exhausted pool fails here instead of crashing on access
+        auto base = mmap(
+            0, linux_round_up(size, LINUX_HUGE_PAGE_SIZE), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+        );
+
+        if (base != MAP_FAILED) {
+            return (u8*) base;
+        }
+    }
+#endif
+
+    // NOTE: Anonymous mapping is already zeroed, touching it would only commit all the pages
     auto base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 
     if (base == MAP_FAILED) {
         return nullptr;
     }
-    else {
-        memset(base, 0, size);
-        return (u8*) base;
+
+    linux_advise_huge_pages(base, size);
+    return (u8*) base;
+}
+
+void platform_free(u8* base, MemoryIndex size) {
+    // NOTE: Huge page mappings can only be unmapped by whole pages
+    if (munmap(base, size) != 0 && errno == EINVAL) {
+        munmap(base, linux_round_up(size, LINUX_HUGE_PAGE_SIZE));
+    }
+}
+
+u8* platform_reserve(MemoryIndex size) {
+    auto base = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+
+    linux_advise_huge_pages(base, size);
+    return (u8*) base;
+}
+
+bool platform_commit(u8* base, MemoryIndex size) {
+    return mprotect(base, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+bool platform_protect_pages(u8* base, MemoryIndex size) {
+    return mprotect(base, size, PROT_NONE) == 0;
+}
+
+void platform_release_pages(u8* base, MemoryIndex size) {
+    const MemoryIndex page_size = platform_get_page_size();
+    u8* first = (u8*) linux_round_up((MemoryIndex) base, page_size);
+    u8* last = (u8*) (((MemoryIndex) base + size) & ~(page_size - 1));
+
+    if (last > first) {
+        madvise(first, last - first, MADV_DONTNEED);
     }
 }
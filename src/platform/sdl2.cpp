@@ -1,11 +1,17 @@
 #include "platform/sdl2.hpp"
 #include "vm.hpp"
+#include "profiler.hpp"
+#include "memory_tracking.hpp"
+#include "recorder.hpp"
 #include "vm_math.hpp"
 #include "vm_glm_adapter.hpp"
 
-Result<Platform> platform_init() {
+Result<Platform> platform_init(ShellConfig const& config) {
+    // NOTE: Headless mode doesn't need a display, but still needs the event queue
+    const Uint32 flags = config.headless ? SDL_INIT_EVENTS : SDL_INIT_VIDEO;
+
     // Init
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+    if (SDL_Init(flags) < 0) {
         return result_create_general_error<Platform>(
             ErrorCode::PlatformInit,
             SDL_GetError()
@@ -22,7 +28,7 @@ Result<Platform> platform_init() {
     return result_create_success(Platform());
 }
 
-Result<Window> platform_create_window(ShellConfig const& config, Platform& platform) {
+static Result<SDL_Window*> platform_create_sdl_window(ShellConfig const& config) {
     auto sdl_window = SDL_CreateWindow(
         config.window_title,
         SDL_WINDOWPOS_CENTERED,
@@ -33,16 +39,34 @@ Result<Window> platform_create_window(ShellConfig const& config, Platform& platf
     );
 
     if (sdl_window == nullptr) {
-        return result_create_general_error<Window>(
+        return result_create_general_error<SDL_Window*>(
             ErrorCode::CreateWindow,
             SDL_GetError()
         );
     }
 
+    return result_create_success(sdl_window);
+}
+
+Result<Window> platform_create_window(ShellConfig const& config, Platform& platform, GrowableRegionMemoryBuffer* assets_memory) {
     Window window = {
-        .sdl_window = sdl_window
+        .sdl_window = nullptr,
+        .headless = config.headless,
+        .width = config.window_width,
+        .height = config.window_height,
+        .damaged = true,
     };
 
+    if (!config.headless) {
+        auto create_sdl_window_result = platform_create_sdl_window(config);
+
+        if (result_has_error(create_sdl_window_result)) {
+            return switch_error<Window>(create_sdl_window_result);
+        }
+
+        window.sdl_window = result_get_payload(create_sdl_window_result);
+    }
+
     auto create_context_result = gapi_create_context(platform, window);
 
     if (result_has_error(create_context_result)) {
@@ -51,7 +75,7 @@ Result<Window> platform_create_window(ShellConfig const& config, Platform& platf
 
     window.gapi_context = result_get_payload(create_context_result);
 
-    auto init_gapi_result = gapi_init(config);
+    auto init_gapi_result = gapi_init(config, assets_memory);
 
     if (result_has_error(init_gapi_result)) {
         return switch_error<Window>(init_gapi_result);
@@ -74,7 +98,37 @@ u8 serialize_mouse_button(int32_t button) {
     }
 }
 
+void platform_push_input_event(InputEvent const& event) {
+    const auto bytes_writer = tech_paws_begin_command("tech.paws.client", Source::Processor, event.command_id);
+
+    switch (event.command_id) {
+        case COMMAND_TOUCH_START:
+        case COMMAND_TOUCH_END:
+            vm_buffers_bytes_writer_write_byte(bytes_writer, event.button);
+            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.x);
+            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.y);
+            break;
+
+        case COMMAND_TOUCH_MOVE:
+        case COMMAND_UPDATE_VIEWPORT:
+            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.x);
+            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.y);
+            break;
+    }
+
+    tech_paws_end_command("tech.paws.client", Source::Processor);
+}
+
+static void platform_handle_input_event(Platform& platform, InputEvent const& event) {
+    platform_push_input_event(event);
+
+    if (platform.recorder != nullptr) {
+        recorder_write_input(platform.recorder, event);
+    }
+}
+
 bool platform_event_loop(Platform& platform, Window& window) {
+    PROFILE_FUNCTION();
     SDL_Event event;
 
     while (SDL_PollEvent(&event)) {
@@ -82,55 +136,86 @@ bool platform_event_loop(Platform& platform, Window& window) {
             return false;
         }
         else if (event.type == SDL_MOUSEBUTTONDOWN) {
-            const auto bytes_writer = tech_paws_begin_command("tech.paws.client", Source::Processor, COMMAND_TOUCH_START);
-
-            vm_buffers_bytes_writer_write_byte(bytes_writer, serialize_mouse_button(event.button.button));
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.button.x);
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.button.y);
-
-            tech_paws_end_command("tech.paws.client", Source::Processor);
+            const InputEvent input_event = {
+                .command_id = COMMAND_TOUCH_START,
+                .button = serialize_mouse_button(event.button.button),
+                .x = event.button.x,
+                .y = event.button.y,
+            };
+
+            platform_handle_input_event(platform, input_event);
         }
         else if (event.type == SDL_MOUSEBUTTONUP) {
-            const auto bytes_writer = tech_paws_begin_command("tech.paws.client", Source::Processor, COMMAND_TOUCH_END);
-
-            vm_buffers_bytes_writer_write_byte(bytes_writer, serialize_mouse_button(event.button.button));
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.button.x);
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.button.y);
-
-            tech_paws_end_command("tech.paws.client", Source::Processor);
+            const InputEvent input_event = {
+                .command_id = COMMAND_TOUCH_END,
+                .button = serialize_mouse_button(event.button.button),
+                .x = event.button.x,
+                .y = event.button.y,
+            };
+
+            platform_handle_input_event(platform, input_event);
         }
         else if (event.type == SDL_MOUSEMOTION) {
-            const auto bytes_writer = tech_paws_begin_command("tech.paws.client", Source::Processor, COMMAND_TOUCH_MOVE);
-
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.motion.x);
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.motion.y);
-
-            tech_paws_end_command("tech.paws.client", Source::Processor);
+            const InputEvent input_event = {
+                .command_id = COMMAND_TOUCH_MOVE,
+                .button = COMMAND_MOUSE_BUTTON_UNKNOWN,
+                .x = event.motion.x,
+                .y = event.motion.y,
+            };
+
+            platform_handle_input_event(platform, input_event);
+        }
+        else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+            window.damaged = true;
         }
         else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESIZED) {
-            const auto bytes_writer = tech_paws_begin_command("tech.paws.client", Source::Processor, COMMAND_UPDATE_VIEWPORT);
+            window.damaged = true;
 
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.window.data1);
-            vm_buffers_bytes_writer_write_int32_t(bytes_writer, event.window.data2);
+            const InputEvent input_event = {
+                .command_id = COMMAND_UPDATE_VIEWPORT,
+                .button = COMMAND_MOUSE_BUTTON_UNKNOWN,
+                .x = event.window.data1,
+                .y = event.window.data2,
+            };
 
-            tech_paws_end_command("tech.paws.client", Source::Processor);
+            platform_handle_input_event(platform, input_event);
         }
     }
 
     return true;
 }
 
+void platform_wait_events(Platform& platform, u32 timeout_ms) {
+    // NOTE: With nullptr the event stays in the queue for platform_event_loop
+    SDL_WaitEventTimeout(nullptr, timeout_ms);
+}
+
+bool platform_consume_window_damage(Window& window) {
+    const bool damaged = window.damaged;
+    window.damaged = false;
+    return damaged;
+}
+
 extern "C" Vec2f platform_get_mouse_state() {
     int x, y;
     SDL_GetMouseState(&x, &y);
     return vm_vec2f(x, y);
 }
 
-float platform_get_ticks() {
-    return SDL_GetTicks();
+f64 platform_get_ticks() {
+    static const f64 frequency = (f64) SDL_GetPerformanceFrequency();
+    return (f64) SDL_GetPerformanceCounter() * 1000.0 / frequency;
+}
+
+void platform_sleep(f64 milliseconds) {
+    SDL_Delay((u32) milliseconds);
 }
 
 void platform_swap_window(Platform& platform, Window& window) {
+    if (window.headless) {
+        return;
+    }
+
     SDL_GL_SwapWindow(window.sdl_window);
 }
 
@@ -140,14 +225,24 @@ void platform_shutdown(Platform& platform) {
 
 void platform_destroy_window(Window& window) {
     gapi_shutdown(window.gapi_context);
-    SDL_DestroyWindow(window.sdl_window);
+
+    if (window.sdl_window != nullptr) {
+        SDL_DestroyWindow(window.sdl_window);
+    }
 }
 
 void platform_get_window_size(Window& window, int* width, int* height) {
+    if (window.headless) {
+        *width = window.width;
+        *height = window.height;
+        return;
+    }
+
     SDL_GetWindowSize(window.sdl_window, width, height);
 }
 
-Result<AssetData> platform_load_font(ShellConfig const& config, RegionMemoryBuffer* dest_memory, const char* asset_name) {
+Result<AssetData> platform_load_font(ShellConfig const& config, GrowableRegionMemoryBuffer* dest_memory, const char* asset_name) {
+    MEMORY_TAG("assets/font");
     char path[1024] { 0 };
     char relative_path[1024] { 0 };
 
@@ -173,7 +268,7 @@ Result<AssetData> platform_load_font(ShellConfig const& config, RegionMemoryBuff
     strcpy(&font.path[0], &path[0]);
     strcpy(&font.relative_path[0], &relative_path[0]);
 
-    Result<u8*> data_result = region_memory_buffer_alloc(dest_memory, sizeof(Font));
+    Result<u8*> data_result = growable_region_memory_buffer_alloc(dest_memory, sizeof(Font));
 
     if (result_has_error(data_result)) {
         return switch_error<AssetData>(data_result);
@@ -191,17 +286,17 @@ Result<AssetData> platform_load_font(ShellConfig const& config, RegionMemoryBuff
     return result_create_success(asset_data);
 }
 
-Result<TTF_Font*> get_sdl2_ttf_font(Font* font, u32 font_size) {
+Result<FontSize*> get_sdl2_font_size(Font* font, u32 font_size) {
     for (size_t i = 0; i < font->sizes_count; i += 1) {
         if (font->sizes[i].size == font_size) {
-            return result_create_success(font->sizes[i].font);
+            return result_create_success(&font->sizes[i]);
         }
     }
 
     auto ttf_font = TTF_OpenFont(&font->path[0], font_size);
 
     if (!ttf_font) {
-        return result_create_general_error<TTF_Font*>(
+        return result_create_general_error<FontSize*>(
             ErrorCode::GetTTFFont,
             TTF_GetError()
         );
@@ -212,6 +307,17 @@ Result<TTF_Font*> get_sdl2_ttf_font(Font* font, u32 font_size) {
 
     font->sizes[font->sizes_count - 1].size = font_size;
     font->sizes[font->sizes_count - 1].font = ttf_font;
+    font->sizes[font->sizes_count - 1].atlas = nullptr;
+
+    return result_create_success(&font->sizes[font->sizes_count - 1]);
+}
+
+Result<TTF_Font*> get_sdl2_ttf_font(Font* font, u32 font_size) {
+    const auto font_size_result = get_sdl2_font_size(font, font_size);
+
+    if (result_has_error(font_size_result)) {
+        return switch_error<TTF_Font*>(font_size_result);
+    }
 
-    return result_create_success(font->sizes[font->sizes_count - 1].font);
+    return result_create_success(result_get_payload(font_size_result)->font);
 }
@@ -5,18 +5,31 @@
 #include "gapi.hpp"
 #include <vector>
 
+struct Recorder;
+
 struct Platform {
     GApi gapi;
+    // NOTE: Set when input events should be recorded
+    Recorder* recorder = nullptr;
 };
 
 struct Window {
+    // NOTE: nullptr in headless mode
     SDL_Window* sdl_window;
     GApiContext gapi_context;
+    bool headless;
+    int width;
+    int height;
+    // Window content was lost or resized and has to be rendered again
+    bool damaged;
 };
 
+struct GlyphAtlas;
+
 struct FontSize {
     u64 size;
     TTF_Font* font;
+    GlyphAtlas* atlas;
 };
 
 struct Font {
@@ -0,0 +1,126 @@
+#include "profiler.hpp"
+#include "platform.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+static std::mutex profiler_threads_mutex;
+static ProfilerThreadBuffer* profiler_threads = nullptr;
+static std::atomic<u32> profiler_next_thread_id { 1 };
+static thread_local ProfilerThreadBuffer* profiler_thread = nullptr;
+
+static const auto profiler_start_time = std::chrono::steady_clock::now();
+
+static inline u64 profiler_now() {
+    const auto elapsed = std::chrono::steady_clock::now() - profiler_start_time;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+static ProfilerThreadBuffer* profiler_get_thread_buffer() {
+    if (profiler_thread != nullptr) {
+        return profiler_thread;
+    }
+
+    // NOTE: platform_alloc returns zeroed memory
+    auto buffer = (ProfilerThreadBuffer*) platform_alloc(sizeof(ProfilerThreadBuffer));
+
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+
+    buffer->thread_id = profiler_next_thread_id.fetch_add(1);
+
+    {
+        std::lock_guard<std::mutex> lock(profiler_threads_mutex);
+        buffer->next = profiler_threads;
+        profiler_threads = buffer;
+    }
+
+    profiler_thread = buffer;
+    return buffer;
+}
+
+u64 profiler_begin(const ProfileZone* zone) {
+    auto buffer = profiler_get_thread_buffer();
+
+    if (buffer == nullptr) {
+        return 0;
+    }
+
+    const u64 sequence = buffer->head + 1;
+    ProfileEvent& event = buffer->events[buffer->head % PROFILER_THREAD_EVENTS_CAPACITY];
+
+    event.zone = zone;
+    event.sequence = sequence;
+    event.end = 0;
+    event.begin = profiler_now();
+
+    buffer->head = sequence;
+    return sequence;
+}
+
+void profiler_end(u64 token) {
+    auto buffer = profiler_thread;
+
+    if (buffer == nullptr || token == 0) {
+        return;
+    }
+
+    ProfileEvent& event = buffer->events[(token - 1) % PROFILER_THREAD_EVENTS_CAPACITY];
+
+    // NOTE: The event has been overwritten by newer ones
+    if (event.sequence != token) {
+        return;
+    }
+
+    event.end = profiler_now();
+}
+
+Result<bool> profiler_export_chrome_trace(const char* path) {
+    FILE* file = fopen(path, "wb");
+
+    if (file == nullptr) {
+        return result_create_general_error<bool>(
+            ErrorCode::ProfilerExport,
+            "Can't open file: %s", path
+        );
+    }
+
+    std::lock_guard<std::mutex> lock(profiler_threads_mutex);
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+
+    for (auto buffer = profiler_threads; buffer != nullptr; buffer = buffer->next) {
+        const u64 head = buffer->head;
+        const u64 count = head < PROFILER_THREAD_EVENTS_CAPACITY ? head : PROFILER_THREAD_EVENTS_CAPACITY;
+
+        for (u64 i = head - count; i < head; i += 1) {
+            const ProfileEvent& event = buffer->events[i % PROFILER_THREAD_EVENTS_CAPACITY];
+
+            if (event.end == 0) {
+                continue;
+            }
+
+            fprintf(
+                file,
+                "%s{\"name\":\"%s\",\"cat\":\"shell\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"file\":\"%s\",\"line\":%u}}",
+                first ? "" : ",\n",
+                event.zone->name,
+                buffer->thread_id,
+                (f64) event.begin / 1000.0,
+                (f64) (event.end - event.begin) / 1000.0,
+                event.zone->file,
+                event.zone->line
+            );
+
+            first = false;
+        }
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+
+    log_info("Profile has been saved to: %s", path);
+    return result_create_success(true);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "primitives.hpp"
+
+// Static description of a profiled code block, one per PROFILE_ZONE call site.
+struct ProfileZone {
+    const char* name;
+    const char* file;
+    u32 line;
+};
+
+struct ProfileEvent {
+    const ProfileZone* zone;
+    u64 sequence;
+    // Nanoseconds since the profiler start, end is 0 while the zone is open
+    u64 begin;
+    u64 end;
+};
+
+// Max number of events per thread, older events are overwritten.
+static const size_t PROFILER_THREAD_EVENTS_CAPACITY = 65536;
+
+struct ProfilerThreadBuffer {
+    u32 thread_id;
+    u64 head;
+    ProfilerThreadBuffer* next;
+    ProfileEvent events[PROFILER_THREAD_EVENTS_CAPACITY];
+};
+
+// Returns the token to pass to profiler_end.
+u64 profiler_begin(const ProfileZone* zone);
+
+void profiler_end(u64 token);
+
+// Reads event buffers of all threads, so it should be called when the other
+// threads have stopped.
+Result<bool> profiler_export_chrome_trace(const char* path);
+
+struct ProfileScope {
+    u64 token;
+
+    ProfileScope(const ProfileZone* zone) : token(profiler_begin(zone)) {}
+    ~ProfileScope() { profiler_end(token); }
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef PROFILE
+
+#define PROFILE_ZONE(zone_name) \
+    static const ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__) = { zone_name, __FILE__, __LINE__ }; \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(&PROFILE_CONCAT(profile_zone_, __LINE__))
+
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
+#define PROFILE_BEGIN(id, zone_name) \
+    static const ProfileZone profile_zone_##id = { zone_name, __FILE__, __LINE__ }; \
+    const u64 profile_token_##id = profiler_begin(&profile_zone_##id)
+
+#define PROFILE_END(id) profiler_end(profile_token_##id)
+
+#else
+
+#define PROFILE_ZONE(zone_name)
+#define PROFILE_FUNCTION()
+#define PROFILE_BEGIN(id, zone_name)
+#define PROFILE_END(id)
+
+#endif
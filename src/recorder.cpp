@@ -0,0 +1,234 @@
+#include "recorder.hpp"
+#include "gapi.hpp"
+#include "gapi/commands.hpp"
+#include "asset_loader.hpp"
+#include "texture_registry.hpp"
+
+Result<Recorder> recorder_open(const char* path) {
+    FILE* file = fopen(path, "wb");
+
+    if (file == nullptr) {
+        return result_create_general_error<Recorder>(
+            ErrorCode::Recording,
+            "Can't open file: %s", path
+        );
+    }
+
+    const RecordingHeader header = {
+        .magic = RECORDING_MAGIC,
+        .version = RECORDING_VERSION,
+    };
+
+    fwrite(&header, sizeof(header), 1, file);
+
+    Recorder recorder = {
+        .file = file,
+        .start_time = platform_get_ticks(),
+        .frames = 0,
+        .bytes = sizeof(header),
+    };
+
+    return result_create_success(recorder);
+}
+
+static void recorder_write(Recorder* recorder, RecordType type, void const* payload, u32 size) {
+    const RecordHeader header = {
+        .type = type,
+        .size = size,
+        .time = platform_get_ticks() - recorder->start_time,
+    };
+
+    fwrite(&header, sizeof(header), 1, recorder->file);
+    fwrite(payload, size, 1, recorder->file);
+
+    recorder->bytes += sizeof(header) + size;
+}
+
+void recorder_write_frame(Recorder* recorder, u8 const* base, u64 size) {
+    // NOTE: Commands buffer is usually much bigger than the commands in it
+    const u64 length = get_commands_buffer_length(base, size);
+
+    recorder_write(recorder, RecordType::frame, base, (u32) length);
+    recorder->frames += 1;
+}
+
+void recorder_write_redraw(Recorder* recorder) {
+    recorder_write(recorder, RecordType::redraw, nullptr, 0);
+    recorder->frames += 1;
+}
+
+void recorder_write_input(Recorder* recorder, InputEvent const& event) {
+    // NOTE: Copied field by field into zeroed memory, so padding doesn't leak into the file
+    InputEvent record;
+    memset(&record, 0, sizeof(record));
+
+    record.command_id = event.command_id;
+    record.button = event.button;
+    record.x = event.x;
+    record.y = event.y;
+
+    recorder_write(recorder, RecordType::input, &record, sizeof(record));
+}
+
+void recorder_write_viewport(Recorder* recorder, int width, int height) {
+    const i32 payload[2] = { width, height };
+    recorder_write(recorder, RecordType::viewport, &payload[0], sizeof(payload));
+}
+
+void recorder_close(Recorder* recorder) {
+    fclose(recorder->file);
+    recorder->file = nullptr;
+
+    log_info("Recorded %llu frames, %llu bytes", (unsigned long long) recorder->frames, (unsigned long long) recorder->bytes);
+}
+
+static Result<AssetData> replay_read_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+
+    if (file == nullptr) {
+        return result_create_general_error<AssetData>(
+            ErrorCode::Recording,
+            "Can't open file: %s", path
+        );
+    }
+
+    fseek(file, 0, SEEK_END);
+    const size_t size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    u8* data = platform_alloc(size);
+
+    if (data == nullptr) {
+        fclose(file);
+        return result_create_general_error<AssetData>(
+            ErrorCode::Allocation,
+            "platform_alloc has failed"
+        );
+    }
+
+    const size_t read = fread(data, 1, size, file);
+    fclose(file);
+
+    if (read != size) {
+        platform_free(data, size);
+        return result_create_general_error<AssetData>(
+            ErrorCode::Recording,
+            "Can't read file: %s", path
+        );
+    }
+
+    AssetData file_data = {
+        .size = size,
+        .data = data,
+    };
+
+    return result_create_success(file_data);
+}
+
+// Waits until textures requested by the frame are uploaded, so every replay renders
+// the same frames no matter how fast the loader threads are.
+static void replay_load_textures(Platform& platform, f64 upload_budget_ms) {
+    texture_registry_update(platform.gapi);
+
+    while (true) {
+        asset_loader_update(platform.gapi, upload_budget_ms, texture_registry_texture_loaded);
+
+        if (!asset_loader_pending()) {
+            break;
+        }
+
+        // NOTE: Gives the loader threads time to decode
+        platform_sleep(REPLAY_LOAD_WAIT_MS);
+    }
+}
+
+static void replay_render(Platform& platform, Window& window, FrameAllocator* frame_allocator, u8* frame, u32 frame_size, int viewport_width, int viewport_height) {
+    frame_allocator_begin_frame(frame_allocator);
+    gapi_clear(0.0f, 0.0f, 0.0f);
+    gapi_render_buffer(platform.gapi, frame, frame_size);
+    gapi_set_viewport(platform.gapi, 0, 0, viewport_width, viewport_height);
+    gapi_swap_window(platform, window);
+}
+
+static Result<ReplayStats> replay_records(Platform& platform, Window& window, FrameAllocator* frame_allocator, u8* data, size_t size, f64 upload_budget_ms) {
+    if (size < sizeof(RecordingHeader)) {
+        return result_create_general_error<ReplayStats>(ErrorCode::Recording, "Recording is too short");
+    }
+
+    const RecordingHeader header = *((RecordingHeader*) data);
+
+    if (header.magic != RECORDING_MAGIC || header.version != RECORDING_VERSION) {
+        return result_create_general_error<ReplayStats>(ErrorCode::Recording, "Unsupported recording format");
+    }
+
+    ReplayStats stats = {};
+    size_t offset = sizeof(RecordingHeader);
+    // Commands buffer of the last frame record, redraws render it again
+    u8* frame = nullptr;
+    u32 frame_size = 0;
+    int viewport_width;
+    int viewport_height;
+
+    platform_get_window_size(window, &viewport_width, &viewport_height);
+
+    const f64 start_time = platform_get_ticks();
+
+    while (offset + sizeof(RecordHeader) <= size) {
+        const RecordHeader record = *((RecordHeader*) (data + offset));
+        u8* payload = data + offset + sizeof(RecordHeader);
+
+        offset += sizeof(RecordHeader) + record.size;
+
+        if (offset > size) {
+            return result_create_general_error<ReplayStats>(ErrorCode::Recording, "Recording is truncated");
+        }
+
+        switch (record.type) {
+            case RecordType::frame:
+                frame = payload;
+                frame_size = record.size;
+                gapi_process_buffer_commands(platform.gapi, frame, frame_size);
+                replay_load_textures(platform, upload_budget_ms);
+                replay_render(platform, window, frame_allocator, frame, frame_size, viewport_width, viewport_height);
+                stats.frames += 1;
+                break;
+
+            case RecordType::redraw:
+                if (frame == nullptr) {
+                    return result_create_general_error<ReplayStats>(ErrorCode::Recording, "Redraw before the first frame");
+                }
+
+                replay_render(platform, window, frame_allocator, frame, frame_size, viewport_width, viewport_height);
+                stats.frames += 1;
+                break;
+
+            // NOTE: Frames are replayed as recorded and the VM isn't stepped,
+            // so input can't change them and is only counted
+            case RecordType::input:
+                stats.inputs += 1;
+                break;
+
+            case RecordType::viewport:
+                viewport_width = ((i32*) payload)[0];
+                viewport_height = ((i32*) payload)[1];
+                break;
+        }
+    }
+
+    stats.time = platform_get_ticks() - start_time;
+    return result_create_success(stats);
+}
+
+Result<ReplayStats> replay_run(Platform& platform, Window& window, FrameAllocator* frame_allocator, const char* path, f64 upload_budget_ms) {
+    auto file_result = replay_read_file(path);
+
+    if (result_has_error(file_result)) {
+        return switch_error<ReplayStats>(file_result);
+    }
+
+    const AssetData file = result_get_payload(file_result);
+    const auto stats_result = replay_records(platform, window, frame_allocator, file.data, file.size, upload_budget_ms);
+
+    platform_free(file.data, file.size);
+    return stats_result;
+}
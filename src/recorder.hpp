@@ -0,0 +1,70 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "platform.hpp"
+#include "frame_allocator.hpp"
+
+// Recording file layout: RecordingHeader followed by records,
+// each one is RecordHeader followed by `size` bytes of payload.
+// NOTE: Numbers are stored in the native byte order.
+
+static const u32 RECORDING_MAGIC = 0x43525054; // "TPRC"
+static const u32 RECORDING_VERSION = 2;
+
+// Sleep between checks while replay waits for the textures of a frame
+static const f64 REPLAY_LOAD_WAIT_MS = 1.0;
+
+enum class RecordType : u32 {
+    // Payload is the used part of the VM commands buffer
+    frame = 1,
+    // Payload is InputEvent
+    input = 2,
+    // Payload is width and height as i32
+    viewport = 3,
+    // No payload, the last frame is rendered again
+    redraw = 4,
+};
+
+struct RecordingHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct RecordHeader {
+    RecordType type;
+    u32 size;
+    // Milliseconds since the recording has been started
+    f64 time;
+};
+
+struct Recorder {
+    FILE* file;
+    f64 start_time;
+    u64 frames;
+    u64 bytes;
+};
+
+struct ReplayStats {
+    u64 frames;
+    // Input events of the recording, they aren't replayed
+    u64 inputs;
+    f64 time;
+};
+
+Result<Recorder> recorder_open(const char* path);
+
+// Should be called for every new commands buffer, redraws of it are written by recorder_write_redraw.
+void recorder_write_frame(Recorder* recorder, u8 const* base, u64 size);
+
+void recorder_write_redraw(Recorder* recorder);
+
+void recorder_write_input(Recorder* recorder, InputEvent const& event);
+
+void recorder_write_viewport(Recorder* recorder, int width, int height);
+
+void recorder_close(Recorder* recorder);
+
+// Renders all recorded frames as fast as possible. Recorded input isn't sent to the VM,
+// the frames already have its effect. Textures a frame requests are loaded before
+// it's rendered, upload_budget_ms per asset_loader_update call.
+Result<ReplayStats> replay_run(Platform& platform, Window& window, FrameAllocator* frame_allocator, const char* path, f64 upload_budget_ms);
@@ -2,22 +2,66 @@
 #include "assets.hpp"
 #include "vm.hpp"
 #include "shell_config.hpp"
+#include "profiler.hpp"
+#include "memory_tracking.hpp"
+#include "asset_loader.hpp"
+#include "texture_registry.hpp"
 
-static void shell_render(Platform& platform, ShellState& shell_state, Window& window);
+static void shell_render(Platform& platform, ShellState& shell_state, Window& window, bool new_buffer);
 
-static bool shell_step(ShellState& shell_state, double deltaTime);
+static void shell_capture_frame(ShellState& shell_state, Window& window);
+
+static bool shell_viewport_changed(ShellState& shell_state, Window& window);
+
+static void shell_log_gpu_times(Platform& platform);
+
+static void shell_log_frame_memory(ShellState& shell_state);
+
+static void shell_log_memory_report(ShellState& shell_state, Platform& platform);
+
+static void shell_collect_frame_stats(Platform& platform, ShellState& shell_state);
+
+static void shell_send_frame_stats(ShellState& shell_state, GApiFrameStats const& gapi_stats);
+
+static bool shell_step(ShellState& shell_state, f64 delta_time);
+
+static f64 shell_asset_upload_budget(ShellState& shell_state);
 
 Result<ShellState> shell_init(ShellConfig const& config) {
     auto shell_state = ShellState();
     shell_state.config = config;
+    frame_scheduler_init(&shell_state.scheduler, PART_TIME, config.target_frame_rate);
 
-    auto buffer_result = create_region_memory_buffer(megabytes(85));
+    const u64 assets_budget = memory_budget(config.assets_memory_mb, SHELL_ASSETS_MEMORY_DEFAULT);
+    const u64 frame_budget = memory_budget(config.frame_memory_mb, SHELL_FRAME_MEMORY_DEFAULT);
+    const u64 frame_size = frame_budget / FRAME_ALLOCATOR_FRAMES;
+
+    auto buffer_result = create_region_memory_buffer(region_memory_buffer_sub_region_size(frame_size) * FRAME_ALLOCATOR_FRAMES);
 
     if (result_is_success(buffer_result)) {
-        auto memory_root_buffer = result_get_payload(buffer_result);
+        MEMORY_TAG("shell/frame_regions");
+        shell_state.memory.root_buffer = result_get_payload(buffer_result);
+        frame_allocator_init(&shell_state.memory.frame_allocator, &shell_state.memory.root_buffer, frame_size);
+
+        const u64 assets_block_size = assets_budget < SHELL_ASSETS_BLOCK_SIZE ? assets_budget : SHELL_ASSETS_BLOCK_SIZE;
+        auto assets_result = create_growable_region_memory_buffer(assets_block_size, assets_budget);
+
+        if (result_has_error(assets_result)) {
+            return switch_error<ShellState>(assets_result);
+        }
+
+        shell_state.memory.assets_buffer = result_get_payload(assets_result);
+
+        if (config.record_path != nullptr) {
+            auto recorder_result = recorder_open(config.record_path);
+
+            if (result_has_error(recorder_result)) {
+                return switch_error<ShellState>(recorder_result);
+            }
 
-        region_memory_buffer_add_region(&memory_root_buffer, &shell_state.memory.assets_buffer, megabytes(40));
-        region_memory_buffer_add_region(&memory_root_buffer, &shell_state.memory.frame_buffer, megabytes(10));
+            shell_state.recorder = result_get_payload(recorder_result);
+            shell_state.recording = true;
+        }
 
         return result_create_success(shell_state);
     } else {
@@ -25,13 +69,42 @@ Result<ShellState> shell_init(ShellConfig const& config) {
     }
 }
 
-void shell_main_loop(ShellState& shell_state, Platform& platform, Window window) {
+void shell_main_loop(ShellState& shell_state, Platform& platform, Window& window) {
+    PROFILE_ZONE("frame");
     FrameInfo& frame_info = shell_state.frame_info;
     frame_info.current_time = platform_get_ticks();
-    frame_info.delta_time = frame_info.last_time - frame_info.current_time;
 
-    if (shell_step(shell_state, frame_info.delta_time) || !shell_state.rendered) {
+    frame_allocator_begin_frame(&shell_state.memory.frame_allocator);
+
+    // NOTE: There is no previous frame yet
+    if (frame_info.last_time == 0.0) {
+        frame_info.last_time = frame_info.current_time;
+    }
+
+    frame_info.delta_time = frame_info.current_time - frame_info.last_time;
+
+    const u32 steps = frame_scheduler_update(&shell_state.scheduler, frame_info.delta_time);
+    bool changed = false;
+
+    for (u32 i = 0; i < steps; i += 1) {
+        changed |= shell_step(shell_state, PART_TIME);
+    }
+
+    texture_registry_update(platform.gapi);
+    asset_loader_update(platform.gapi, shell_asset_upload_budget(shell_state), texture_registry_texture_loaded);
+
+    bool new_buffer = false;
+
+    if (changed || !shell_state.rendered) {
+        PROFILE_BEGIN(render_commands, "tech_paws_vm_process_render_commands");
         tech_paws_vm_process_render_commands();
+        PROFILE_END(render_commands);
+
+        // NOTE: Requests and asset commands are handled once here, not on every redraw of the buffer
+        const auto commands_buffer = tech_paws_vm_get_commands_buffer();
+        gapi_process_buffer_commands(platform.gapi, commands_buffer.base, commands_buffer.size);
+        new_buffer = true;
+
         collect_text_bounds(platform.gapi);
 
         // tech_paws_vm_flush();
@@ -42,30 +115,326 @@ void shell_main_loop(ShellState& shell_state, Platform& platform, Window window)
             frame_info.fps = frame_info.frames;
             frame_info.frames = 1;
 
-            printf("FPS: %d\n", frame_info.fps);
+            const auto summary = frame_stats_summarize(&shell_state.frame_stats);
+            printf(
+                "FPS: %d, frame time p50: %.2f ms, p95: %.2f ms, p99: %.2f ms\n",
+                frame_info.fps,
+                summary.frame_time_p50,
+                summary.frame_time_p95,
+                summary.frame_time_p99
+            );
+
+            const auto stats = gapi_get_frame_stats(platform.gapi);
+            printf(
+                "Commands: %llu, skipped: %llu, batches: %llu, draw calls: %llu, state changes: %llu, elided: %llu\n",
+                (unsigned long long) stats.commands,
+                (unsigned long long) stats.commands_skipped,
+                (unsigned long long) stats.batches,
+                (unsigned long long) stats.draw_calls,
+                (unsigned long long) stats.state_changes,
+                (unsigned long long) stats.state_changes_elided
+            );
+
+            shell_log_frame_memory(shell_state);
+            shell_log_gpu_times(platform);
         }
     }
 
-    shell_render(platform, shell_state, window);
-    shell_state.rendered = true;
-    gapi_swap_window(platform, window);
+    // NOTE: Both should be checked to consume damage and remember viewport
+    const bool damaged = platform_consume_window_damage(window);
+    const bool viewport_changed = shell_viewport_changed(shell_state, window);
+    const bool idle_mode = shell_state.config.idle_timeout_ms > 0;
+
+    if (!idle_mode || changed || damaged || viewport_changed || !shell_state.rendered) {
+        shell_render(platform, shell_state, window, new_buffer);
+        shell_state.rendered = true;
+        shell_state.frames_rendered += 1;
+
+        const int max_frames = shell_state.config.max_frames;
+
+        if (max_frames > 0 && shell_state.frames_rendered >= (u64) max_frames) {
+            if (shell_state.config.capture_path != nullptr) {
+                shell_capture_frame(shell_state, window);
+            }
+
+            shell_state.finished = true;
+        }
+
+        PROFILE_BEGIN(swap_window, "gapi_swap_window");
+        gapi_swap_window(platform, window);
+        PROFILE_END(swap_window);
+
+        PROFILE_BEGIN(frame_pacing, "frame_scheduler_wait");
+        frame_scheduler_wait(&shell_state.scheduler);
+        PROFILE_END(frame_pacing);
+
+        shell_collect_frame_stats(platform, shell_state);
+    }
+    else if (steps > 0) {
+        // NOTE: The VM has stepped and nothing has changed, the last frame is still on the screen
+        PROFILE_BEGIN(wait_events, "platform_wait_events");
+        platform_wait_events(platform, shell_state.config.idle_timeout_ms);
+        PROFILE_END(wait_events);
+
+        frame_scheduler_wake(&shell_state.scheduler);
+        frame_info.current_time = platform_get_ticks();
+    }
+    else {
+        // NOTE: No step was due yet, so nothing is known to be idle. Sleep until the next step,
+        // the waited time stays in the delta and is accumulated by the next update.
+        PROFILE_BEGIN(wait_step, "platform_wait_events");
+        platform_wait_events(platform, frame_scheduler_time_to_step(&shell_state.scheduler));
+        PROFILE_END(wait_step);
+    }
+
     frame_info.last_time = frame_info.current_time;
 }
 
-static void shell_render(Platform& platform, ShellState& shell_state, Window& window) {
+static bool shell_viewport_changed(ShellState& shell_state, Window& window) {
+    int width;
+    int height;
+
+    platform_get_window_size(window, &width, &height);
+
+    if (width == shell_state.viewport_width && height == shell_state.viewport_height) {
+        return false;
+    }
+
+    shell_state.viewport_width = width;
+    shell_state.viewport_height = height;
+
+    if (shell_state.recording) {
+        recorder_write_viewport(&shell_state.recorder, width, height);
+    }
+
+    return true;
+}
+
+static void shell_log_gpu_times(Platform& platform) {
+    GApiCommandGpuTime times[32];
+    const size_t count = gapi_get_command_gpu_times(platform.gapi, &times[0], 32);
+
+    if (count == 0) {
+        return;
+    }
+
+    printf("GPU frame time: %.3f ms\n", gapi_get_gpu_frame_time(platform.gapi));
+
+    for (size_t i = 0; i < count; i += 1) {
+        printf(
+            "  %s: avg %.3f ms, max %.3f ms, frames: %llu\n",
+            vm_command_name(times[i].command_id),
+            times[i].average_ms,
+            times[i].max_ms,
+            (unsigned long long) times[i].frames
+        );
+    }
+
+    gapi_reset_command_gpu_times(platform.gapi);
+}
+
+static void shell_collect_frame_stats(Platform& platform, ShellState& shell_state) {
+    const auto gapi_stats = gapi_get_frame_stats(platform.gapi);
+
+    const FrameStatsSample sample = {
+        .frame_time = platform_get_ticks() - shell_state.frame_info.current_time,
+        .draw_calls = gapi_stats.draw_calls,
+        .instances = gapi_stats.instances,
+        .vertices = gapi_stats.vertices,
+        .uploaded_bytes = gapi_stats.uploaded_bytes,
+        .texture_uploads = gapi_stats.texture_uploads,
+        .texture_upload_bytes = gapi_stats.texture_upload_bytes,
+        .command_bytes = gapi_stats.command_bytes,
+    };
+
+    frame_stats_push(&shell_state.frame_stats, sample);
+
+    if (gapi_consume_frame_stats_request(platform.gapi)) {
+        shell_send_frame_stats(shell_state, gapi_stats);
+    }
+}
+
+static void shell_send_frame_stats(ShellState& shell_state, GApiFrameStats const& gapi_stats) {
+    const auto summary = frame_stats_summarize(&shell_state.frame_stats);
+    const auto bytes_writer = tech_paws_begin_command("tech.paws.client", Source::Processor, COMMAND_STATE_FRAME_STATS);
+
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, summary.frames);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.frame_time_average);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.frame_time_p50);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.frame_time_p95);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.frame_time_p99);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.frame_time_max);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.draw_calls_average);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.instances_average);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.vertices_average);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.uploaded_bytes_average);
+    vm_buffers_bytes_writer_write_float(bytes_writer, summary.command_bytes_average);
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, summary.texture_uploads);
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, summary.texture_upload_bytes);
+
+    // Memory high-water marks
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, shell_state.memory.assets_buffer.high_water);
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, shell_state.memory.frame_allocator.stats.high_water);
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, gapi_stats.memory_high_water);
+
+    tech_paws_end_command("tech.paws.client", Source::Processor);
+}
+
+// Saves the rendered frame as binary PPM.
+static void shell_capture_frame(ShellState& shell_state, Window& window) {
+    int width;
+    int height;
+
+    platform_get_window_size(window, &width, &height);
+
+    const size_t size = (size_t) width * height * 4;
+    MEMORY_TAG("shell/capture");
+    auto pixels_result = frame_allocator_alloc(&shell_state.memory.frame_allocator, size, MEMORY_DEFAULT_ALIGNMENT);
+
+    if (result_has_error(pixels_result)) {
+        log_error(pixels_result.error.message);
+        return;
+    }
+
+    u8* pixels = result_get_payload(pixels_result);
+    const auto read_result = gapi_read_frame(window, pixels, size);
+
+    if (result_has_error(read_result)) {
+        log_error(read_result.error.message);
+        return;
+    }
+
+    FILE* file = fopen(shell_state.config.capture_path, "wb");
+
+    if (file == nullptr) {
+        log_error("Can't open file: %s", shell_state.config.capture_path);
+        return;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+    for (size_t i = 0; i < size; i += 4) {
+        fwrite(&pixels[i], 1, 3, file);
+    }
+
+    fclose(file);
+    log_info("Frame has been saved to: %s", shell_state.config.capture_path);
+}
+
+static void shell_log_frame_memory(ShellState& shell_state) {
+    const FrameAllocatorStats& stats = shell_state.memory.frame_allocator.stats;
+
+    printf(
+        "Frame memory high water: %llu of %llu bytes, overflows: %llu (%llu bytes)\n",
+        (unsigned long long) stats.high_water,
+        (unsigned long long) stats.frame_size,
+        (unsigned long long) stats.overflow_allocations,
+        (unsigned long long) stats.overflow_bytes
+    );
+}
+
+static void shell_log_memory_usage(const char* name, MemoryUsage const& usage) {
+    printf(
+        "  %-8s used: %llu, peak: %llu, capacity: %llu bytes\n",
+        name,
+        (unsigned long long) usage.used,
+        (unsigned long long) usage.high_water,
+        (unsigned long long) usage.capacity
+    );
+}
+
+static void shell_log_memory_report(ShellState& shell_state, Platform& platform) {
+    const ShellMemory& memory = shell_state.memory;
+
+    printf("Memory report:\n");
+    shell_log_memory_usage("root", region_memory_buffer_get_usage(&memory.root_buffer));
+    shell_log_memory_usage("assets", growable_region_memory_buffer_get_usage(&memory.assets_buffer));
+
+    for (u32 i = 0; i < FRAME_ALLOCATOR_FRAMES; i += 1) {
+        char name[16];
+        snprintf(&name[0], sizeof(name), "frame %u", i);
+        shell_log_memory_usage(&name[0], region_memory_buffer_get_usage(&memory.frame_allocator.frames[i]));
+    }
+
+    shell_log_memory_usage("gapi", gapi_get_memory_usage(platform.gapi));
+
+    const auto textures = texture_registry_get_stats();
+    printf(
+        "  textures: %llu, %llu bytes, loads: %llu, deduplicated: %llu\n",
+        (unsigned long long) textures.textures,
+        (unsigned long long) textures.bytes,
+        (unsigned long long) textures.loads,
+        (unsigned long long) textures.deduplicated_loads
+    );
+    shell_log_frame_memory(shell_state);
+}
+
+static void shell_render(Platform& platform, ShellState& shell_state, Window& window, bool new_buffer) {
+    const auto commands_buffer = tech_paws_vm_get_commands_buffer();
+
+    if (shell_state.recording && new_buffer) {
+        recorder_write_frame(&shell_state.recorder, commands_buffer.base, commands_buffer.size);
+    }
+    else if (shell_state.recording) {
+        recorder_write_redraw(&shell_state.recorder);
+    }
+
     gapi_clear(0.0f, 0.0f, 0.0f);
-    gapi_render(platform.gapi);
+    gapi_render_buffer(platform.gapi, commands_buffer.base, commands_buffer.size);
 
     int width;
     int height;
 
     platform_get_window_size(window, &width, &height);
-    gapi_set_viewport(0, 0, width, height);
+    gapi_set_viewport(platform.gapi, 0, 0, width, height);
 }
 
-static bool shell_step(ShellState& shell_state, double delta_time) {
+static bool shell_step(ShellState& shell_state, f64 delta_time) {
+    PROFILE_ZONE("tech_paws_vm_process_commands");
     return tech_paws_vm_process_commands();
 }
 
-void shell_shutdown() {
+static f64 shell_asset_upload_budget(ShellState& shell_state) {
+    return shell_state.config.asset_upload_budget_ms > 0.f
+        ? (f64) shell_state.config.asset_upload_budget_ms
+        : ASSET_LOADER_UPLOAD_BUDGET_DEFAULT;
+}
+
+void shell_replay(ShellState& shell_state, Platform& platform, Window& window) {
+    const auto replay_result = replay_run(
+        platform,
+        window,
+        &shell_state.memory.frame_allocator,
+        shell_state.config.replay_path,
+        shell_asset_upload_budget(shell_state)
+    );
+
+    if (result_has_error(replay_result)) {
+        log_error(replay_result.error.message);
+        return;
+    }
+
+    const ReplayStats stats = result_get_payload(replay_result);
+    const f64 fps = stats.time > 0.0 ? stats.frames * 1000.0 / stats.time : 0.0;
+
+    log_info(
+        "Replayed %llu frames in %.3f ms (%.1f FPS), skipped %llu input events",
+        (unsigned long long) stats.frames,
+        stats.time,
+        fps,
+        (unsigned long long) stats.inputs
+    );
+}
+
+void shell_shutdown(ShellState& shell_state, Platform& platform) {
+    if (shell_state.recording) {
+        recorder_close(&shell_state.recorder);
+        shell_state.recording = false;
+    }
+
+    shell_log_memory_report(shell_state, platform);
+#ifdef MEMORY_TRACKING
+    memory_tracking_log_report();
+#endif
+    frame_allocator_free(&shell_state.memory.frame_allocator);
 }
@@ -6,10 +6,21 @@
 #include "shell_state.hpp"
 #include "shell_config.hpp"
 
-static const float PART_TIME = 1000.f / 120.f;
+// Fixed simulation step in milliseconds
+static const f64 PART_TIME = 1000.0 / 120.0;
+
+// Memory budgets when ShellConfig doesn't set them
+static const u64 SHELL_ASSETS_MEMORY_DEFAULT = megabytes(40);
+static const u64 SHELL_FRAME_MEMORY_DEFAULT = megabytes(10);
+
+// Assets memory grows by blocks of this size
+static const u64 SHELL_ASSETS_BLOCK_SIZE = megabytes(8);
 
 Result<ShellState> shell_init(ShellConfig const& config);
 
-void shell_main_loop(ShellState& shell_state, Platform& platform, Window window);
+void shell_main_loop(ShellState& shell_state, Platform& platform, Window& window);
+
+// Replays config.replay_path instead of the main loop.
+void shell_replay(ShellState& shell_state, Platform& platform, Window& window);
 
-void shell_shutdown();
+void shell_shutdown(ShellState& shell_state, Platform& platform);
@@ -1,8 +1,47 @@
 #pragma once
 
+#include "primitives.hpp"
+
+// NOTE: Passed by value through sdl2shell_run, so the host has to be rebuilt
+// whenever fields are added. The size is checked to catch hosts built against another layout.
 struct ShellConfig {
+    // Should be set by the host to sizeof(ShellConfig)
+    u32 size;
     char const* assets_path;
     char const* window_title;
     int window_width;
     int window_height;
+    // Idle mode: when > 0 and nothing has changed, the shell doesn't render
+    // and waits for events up to this amount of milliseconds instead.
+    int idle_timeout_ms;
+    // Frames per second to pace the main loop to, 0 means unlimited (or vsync)
+    int target_frame_rate;
+    // Where to save Chrome trace JSON on shutdown when built with PROFILE=1,
+    // nullptr to not save.
+    char const* profile_trace_path;
+    // Headless mode: renders into an offscreen framebuffer of window_width x window_height
+    // without a window and a display server, e.g. for benchmarks and tests.
+    bool headless;
+    // Number of frames to render before exit, 0 to run until quit
+    int max_frames;
+    // Where to save the last frame as PPM image when max_frames is reached,
+    // nullptr to not save.
+    char const* capture_path;
+    // Where to record commands buffers, input and viewport changes, nullptr to not record
+    char const* record_path;
+    // When set the shell replays the recording as fast as possible instead of running
+    char const* replay_path;
+    // Number of worker threads to pre-process commands on, 0 starts one per core
+    // except the main thread, negative runs everything on the main thread.
+    int worker_threads;
+    // Huge pages for memory regions: 0 - regular pages, 1 - transparent huge pages,
+    // 2 - explicit huge pages, they should be configured in the system.
+    int huge_pages;
+    // Memory budgets in megabytes, 0 for the defaults: assets grow by blocks
+    // up to their budget, frame memory is split between the frame regions.
+    int assets_memory_mb;
+    int frame_memory_mb;
+    int gapi_memory_mb;
+    // Milliseconds per frame to upload loaded textures to the GPU, 0 for the default
+    float asset_upload_budget_ms;
 };
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "memory.hpp"
+#include "frame_allocator.hpp"
 
 struct ShellMemory {
     RegionMemoryBuffer root_buffer;
-    RegionMemoryBuffer assets_buffer;
-    RegionMemoryBuffer frame_buffer;
+    GrowableRegionMemoryBuffer assets_buffer;
+    FrameAllocator frame_allocator;
 };
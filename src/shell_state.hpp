@@ -6,12 +6,15 @@
 #include "shell_memory.hpp"
 #include "shell_config.hpp"
 #include "vm.hpp"
+#include "frame_scheduler.hpp"
+#include "frame_stats.hpp"
+#include "recorder.hpp"
 
 struct FrameInfo {
-    float current_time = 0.f;
-    float last_time = 0.f;
-    float delta_time = 0.f;
-    float frame_time = 0.f;
+    f64 current_time = 0.0;
+    f64 last_time = 0.0;
+    f64 delta_time = 0.0;
+    f64 frame_time = 0.0;
     int frames = 0;
     int fps = 0;
 };
@@ -19,6 +22,15 @@ struct FrameInfo {
 struct ShellState {
     ShellConfig config;
     FrameInfo frame_info;
+    FrameScheduler scheduler;
+    FrameStats frame_stats;
+    bool recording = false;
+    Recorder recorder;
     ShellMemory memory;
     bool rendered = false;
+    int viewport_width = 0;
+    int viewport_height = 0;
+    u64 frames_rendered = 0;
+    // Set when config.max_frames have been rendered
+    bool finished = false;
 };
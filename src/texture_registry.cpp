@@ -0,0 +1,382 @@
+#include "texture_registry.hpp"
+#include "asset_loader.hpp"
+#include "gapi/commands.hpp"
+#include "profiler.hpp"
+#include "log.hpp"
+
+enum class TextureEntryState {
+    free,
+    loading,
+    loaded,
+};
+
+struct TextureEntry {
+    TextureEntryState state;
+    // Bumped when the entry is freed, so handles of removed textures become stale
+    u32 generation;
+    u32 refs;
+    // Load requests that are waiting for the reply
+    u32 waiting;
+    u32 hash;
+    u32 next_free;
+    Texture2D texture;
+    char name[GAPI_ADDRESS_CAPACITY];
+};
+
+// NOTE: Used from the main thread only, commands and asset loader callbacks run on it
+struct TextureRegistry {
+    TextureEntry entries[TEXTURE_REGISTRY_CAPACITY];
+    u32 free_head;
+    // Open addressing with linear probing by name, 0 is an empty slot,
+    // otherwise the entry index + 1
+    u32 index[TEXTURE_REGISTRY_INDEX_CAPACITY];
+    Texture2D pending_deletes[TEXTURE_REGISTRY_CAPACITY];
+    u32 pending_deletes_count;
+    TextureRegistryStats stats;
+};
+
+static const u32 TEXTURE_REGISTRY_NONE = 0xFFFFFFFF;
+
+static const char* TEXTURE_REGISTRY_CLIENT = "tech.paws.client";
+
+static TextureRegistry texture_registry;
+
+// FNV-1a
+static u32 texture_registry_hash(char const* name) {
+    u32 hash = 2166136261u;
+
+    for (char const* c = name; *c != '\0'; c += 1) {
+        hash ^= (u8) *c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Handle is the generation in the high half and the entry index + 1 in the low one,
+// so 0 is never a valid handle.
+static u64 texture_registry_make_handle(u32 index) {
+    return ((u64) texture_registry.entries[index].generation << 32) | (u64) (index + 1);
+}
+
+static bool texture_registry_resolve(u64 handle, u32* index) {
+    const u32 entry_index = (u32) (handle & 0xFFFFFFFF) - 1;
+    const u32 generation = (u32) (handle >> 32);
+
+    if (entry_index >= TEXTURE_REGISTRY_CAPACITY) {
+        return false;
+    }
+
+    TextureEntry const& entry = texture_registry.entries[entry_index];
+
+    if (entry.state == TextureEntryState::free || entry.generation != generation) {
+        return false;
+    }
+
+    *index = entry_index;
+    return true;
+}
+
+static u32 texture_registry_find(char const* name, u32 hash) {
+    const u32 mask = TEXTURE_REGISTRY_INDEX_CAPACITY - 1;
+
+    for (u32 slot = hash & mask;; slot = (slot + 1) & mask) {
+        const u32 value = texture_registry.index[slot];
+
+        if (value == 0) {
+            return TEXTURE_REGISTRY_NONE;
+        }
+
+        TextureEntry const& entry = texture_registry.entries[value - 1];
+
+        if (entry.hash == hash && strcmp(&entry.name[0], name) == 0) {
+            return value - 1;
+        }
+    }
+}
+
+// NOTE: Never full, there are more slots than entries
+static void texture_registry_index_insert(u32 index) {
+    const u32 mask = TEXTURE_REGISTRY_INDEX_CAPACITY - 1;
+    u32 slot = texture_registry.entries[index].hash & mask;
+
+    while (texture_registry.index[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+
+    texture_registry.index[slot] = index + 1;
+}
+
+// Shifts the following entries of the probe sequence back instead of leaving a tombstone.
+static void texture_registry_index_remove(u32 index) {
+    const u32 mask = TEXTURE_REGISTRY_INDEX_CAPACITY - 1;
+    u32 hole = texture_registry.entries[index].hash & mask;
+
+    while (texture_registry.index[hole] != index + 1) {
+        hole = (hole + 1) & mask;
+    }
+
+    for (u32 slot = (hole + 1) & mask; texture_registry.index[slot] != 0; slot = (slot + 1) & mask) {
+        const u32 home = texture_registry.entries[texture_registry.index[slot] - 1].hash & mask;
+
+        // NOTE: Entry stays if its home slot is cyclically in (hole, slot]
+        const bool stays = hole <= slot
+            ? hole < home && home <= slot
+            : hole < home || home <= slot;
+
+        if (!stays) {
+            texture_registry.index[hole] = texture_registry.index[slot];
+            hole = slot;
+        }
+    }
+
+    texture_registry.index[hole] = 0;
+}
+
+static u32 texture_registry_alloc_entry(char const* name, u32 hash) {
+    const u32 index = texture_registry.free_head;
+
+    if (index == TEXTURE_REGISTRY_NONE) {
+        return TEXTURE_REGISTRY_NONE;
+    }
+
+    TextureEntry& entry = texture_registry.entries[index];
+    texture_registry.free_head = entry.next_free;
+
+    entry.state = TextureEntryState::loading;
+    entry.refs = 1;
+    entry.waiting = 1;
+    entry.hash = hash;
+    entry.next_free = TEXTURE_REGISTRY_NONE;
+    entry.texture = Texture2D();
+    copy_address(&entry.name[0], (u8 const*) name, strlen(name));
+
+    texture_registry_index_insert(index);
+    return index;
+}
+
+static void texture_registry_free_entry(u32 index) {
+    TextureEntry& entry = texture_registry.entries[index];
+
+    texture_registry_index_remove(index);
+
+    entry.state = TextureEntryState::free;
+    entry.generation += 1;
+
+    if (entry.generation == 0) {
+        entry.generation = 1;
+    }
+
+    entry.next_free = texture_registry.free_head;
+    texture_registry.free_head = index;
+}
+
+// NOTE: Drivers usually keep RGB textures as RGBA, so 4 bytes per pixel are counted
+static u64 texture_registry_texture_size(Texture2D const& texture) {
+    return (u64) texture.width * texture.height * 4;
+}
+
+// Payload: i32 status (0 - loaded, 1 - failed), i64 texture handle, i32 width, i32 height,
+// then the name of the texture as length prefixed string.
+static void texture_registry_send_texture_loaded(char const* name, u64 handle, Texture2D const* texture) {
+    const u64 name_len = strlen(name);
+    const auto bytes_writer = tech_paws_begin_command(TEXTURE_REGISTRY_CLIENT, Source::Processor, COMMAND_ASSET_TEXTURE_LOADED);
+
+    vm_buffers_bytes_writer_write_int32_t(bytes_writer, texture != nullptr ? 0 : 1);
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, (i64) handle);
+    vm_buffers_bytes_writer_write_int32_t(bytes_writer, texture != nullptr ? (i32) texture->width : 0);
+    vm_buffers_bytes_writer_write_int32_t(bytes_writer, texture != nullptr ? (i32) texture->height : 0);
+    vm_buffers_bytes_writer_write_int64_t(bytes_writer, (i64) name_len);
+
+    for (u64 i = 0; i < name_len; i += 1) {
+        vm_buffers_bytes_writer_write_byte(bytes_writer, (u8) name[i]);
+    }
+
+    tech_paws_end_command(TEXTURE_REGISTRY_CLIENT, Source::Processor);
+}
+
+void texture_registry_init() {
+    memset(&texture_registry.index[0], 0, sizeof(texture_registry.index));
+    texture_registry.pending_deletes_count = 0;
+    texture_registry.stats = {};
+
+    for (u32 i = 0; i < TEXTURE_REGISTRY_CAPACITY; i += 1) {
+        TextureEntry& entry = texture_registry.entries[i];
+        entry.state = TextureEntryState::free;
+        entry.generation = 1;
+        entry.next_free = i + 1 < TEXTURE_REGISTRY_CAPACITY ? i + 1 : TEXTURE_REGISTRY_NONE;
+    }
+
+    texture_registry.free_head = 0;
+}
+
+void texture_registry_shutdown(GApi& gapi) {
+    texture_registry_update(gapi);
+
+    for (u32 i = 0; i < TEXTURE_REGISTRY_CAPACITY; i += 1) {
+        if (texture_registry.entries[i].state == TextureEntryState::loaded) {
+            gapi_delete_texture_2d(gapi, texture_registry.entries[i].texture);
+            texture_registry_free_entry(i);
+        }
+    }
+
+    texture_registry.stats.textures = 0;
+    texture_registry.stats.bytes = 0;
+}
+
+void texture_registry_update(GApi& gapi) {
+    for (u32 i = 0; i < texture_registry.pending_deletes_count; i += 1) {
+        gapi_delete_texture_2d(gapi, texture_registry.pending_deletes[i]);
+    }
+
+    texture_registry.pending_deletes_count = 0;
+}
+
+void texture_registry_texture_loaded(GApi& gapi, char const* name, Texture2D const* texture) {
+    const u32 index = texture_registry_find(name, texture_registry_hash(name));
+
+    // NOTE: Shouldn't happen, handles are sent only for loaded textures,
+    // so a texture can't be removed while it's loading
+    if (index == TEXTURE_REGISTRY_NONE || texture_registry.entries[index].state != TextureEntryState::loading) {
+        if (texture != nullptr) {
+            gapi_delete_texture_2d(gapi, *texture);
+        }
+
+        return;
+    }
+
+    TextureEntry& entry = texture_registry.entries[index];
+
+    if (texture == nullptr) {
+        for (u32 i = 0; i < entry.waiting; i += 1) {
+            texture_registry_send_texture_loaded(&entry.name[0], 0, nullptr);
+        }
+
+        // NOTE: Freed, so the next request tries to load it again
+        texture_registry_free_entry(index);
+        return;
+    }
+
+    entry.state = TextureEntryState::loaded;
+    entry.texture = *texture;
+
+    texture_registry.stats.textures += 1;
+    texture_registry.stats.bytes += texture_registry_texture_size(entry.texture);
+
+    const u64 handle = texture_registry_make_handle(index);
+
+    for (u32 i = 0; i < entry.waiting; i += 1) {
+        texture_registry_send_texture_loaded(&entry.name[0], handle, &entry.texture);
+    }
+
+    entry.waiting = 0;
+}
+
+Texture2D const* texture_registry_get(u64 handle) {
+    u32 index;
+
+    if (!texture_registry_resolve(handle, &index) || texture_registry.entries[index].state != TextureEntryState::loaded) {
+        return nullptr;
+    }
+
+    return &texture_registry.entries[index].texture;
+}
+
+TextureRegistryStats texture_registry_get_stats() {
+    return texture_registry.stats;
+}
+
+// Payload: texture name as length prefixed string. Every request gets
+// COMMAND_ASSET_TEXTURE_LOADED, textures that are already loaded get it right away.
+static void texture_registry_load_texture(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+
+    char name[GAPI_ADDRESS_CAPACITY];
+    read_address(reader, &name[0]);
+
+    const u32 hash = texture_registry_hash(&name[0]);
+    u32 index = texture_registry_find(&name[0], hash);
+
+    if (index != TEXTURE_REGISTRY_NONE) {
+        TextureEntry& entry = texture_registry.entries[index];
+
+        entry.refs += 1;
+        texture_registry.stats.deduplicated_loads += 1;
+
+        if (entry.state == TextureEntryState::loaded) {
+            texture_registry_send_texture_loaded(&entry.name[0], texture_registry_make_handle(index), &entry.texture);
+        }
+        else {
+            entry.waiting += 1;
+        }
+
+        return;
+    }
+
+    if (texture_registry.free_head == TEXTURE_REGISTRY_NONE) {
+        log_warn("Texture registry is full, can't load texture: %s", &name[0]);
+        texture_registry_send_texture_loaded(&name[0], 0, nullptr);
+        return;
+    }
+
+    if (!asset_loader_request_texture(&name[0])) {
+        log_warn("Asset loader queue is full, can't load texture: %s", &name[0]);
+        texture_registry_send_texture_loaded(&name[0], 0, nullptr);
+        return;
+    }
+
+    texture_registry_alloc_entry(&name[0], hash);
+    texture_registry.stats.loads += 1;
+}
+
+// Payload: i64 texture handle, the texture is deleted when all loads of it are removed.
+static void texture_registry_remove_texture(GApi& gapi, CommandReader* reader) {
+    PROFILE_FUNCTION();
+
+    const auto handle = (u64) read_int64(reader);
+    u32 index;
+
+    // NOTE: Handles are sent only for loaded textures, so any other state is a stale handle
+    if (!texture_registry_resolve(handle, &index) || texture_registry.entries[index].state != TextureEntryState::loaded) {
+        log_warn("Can't remove texture, handle %llx is stale", (unsigned long long) handle);
+        return;
+    }
+
+    TextureEntry& entry = texture_registry.entries[index];
+    entry.refs -= 1;
+
+    if (entry.refs > 0) {
+        return;
+    }
+
+    if (texture_registry.pending_deletes_count < TEXTURE_REGISTRY_CAPACITY) {
+        texture_registry.pending_deletes[texture_registry.pending_deletes_count] = entry.texture;
+        texture_registry.pending_deletes_count += 1;
+    }
+    else {
+        gapi_delete_texture_2d(gapi, entry.texture);
+    }
+
+    texture_registry.stats.textures -= 1;
+    texture_registry.stats.bytes -= texture_registry_texture_size(entry.texture);
+    texture_registry_free_entry(index);
+}
+
+Result<bool> texture_registry_register_commands(GApi& gapi) {
+    // NOTE: Loads and removes change refcounts, so they are handled once per commands buffer, not on redraws
+    if (!gapi_register_buffer_command_handler(gapi, COMMAND_ASSET_LOAD_TEXTURE, texture_registry_load_texture)) {
+        return result_create_general_error<bool>(
+            ErrorCode::TextureRegistryInit,
+            "Can't register handler of command %llx", (unsigned long long) COMMAND_ASSET_LOAD_TEXTURE
+        );
+    }
+
+    if (!gapi_register_buffer_command_handler(gapi, COMMAND_ASSET_REMOVE_TEXTURE, texture_registry_remove_texture)) {
+        return result_create_general_error<bool>(
+            ErrorCode::TextureRegistryInit,
+            "Can't register handler of command %llx", (unsigned long long) COMMAND_ASSET_REMOVE_TEXTURE
+        );
+    }
+
+    return result_create_success(true);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "primitives.hpp"
+#include "gapi.hpp"
+
+// Max number of textures the client can have loaded at once
+static const u32 TEXTURE_REGISTRY_CAPACITY = 1024;
+
+// NOTE: Power of two, twice the capacity keeps probe sequences short
+static const u32 TEXTURE_REGISTRY_INDEX_CAPACITY = 2048;
+
+struct TextureRegistryStats {
+    u64 textures;
+    // Approximate GPU memory of the loaded textures
+    u64 bytes;
+    u64 loads;
+    // Loads served by a texture that was already loaded or loading
+    u64 deduplicated_loads;
+};
+
+void texture_registry_init();
+
+// Deletes all textures, should be called while the GAPI context is alive.
+void texture_registry_shutdown(GApi& gapi);
+
+// Handles COMMAND_ASSET_LOAD_TEXTURE and COMMAND_ASSET_REMOVE_TEXTURE once per commands buffer,
+// see gapi_process_buffer_commands. It's the only handler of them.
+Result<bool> texture_registry_register_commands(GApi& gapi);
+
+// Deletes textures removed during the previous frame, they can't be deleted while
+// the commands buffer that removed them is rendered.
+void texture_registry_update(GApi& gapi);
+
+// Callback for asset_loader_update.
+void texture_registry_texture_loaded(GApi& gapi, char const* name, Texture2D const* texture);
+
+// Returns nullptr for 0, stale handles and textures that are still loading.
+Texture2D const* texture_registry_get(u64 handle);
+
+TextureRegistryStats texture_registry_get_stats();
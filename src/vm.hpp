@@ -29,9 +29,49 @@ static const u64 COMMAND_ASSET_LOAD_TEXTURE = 0x00040001;
 static const u64 COMMAND_ASSET_LOAD_MACRO = 0x00040002;
 static const u64 COMMAND_ASSET_REMOVE_TEXTURE = 0x00040003;
 static const u64 COMMAND_ASSET_REMOVE_MACRO = 0x00040004;
+// NOTE: Reply to COMMAND_ASSET_LOAD_TEXTURE, see texture_registry_send_texture_loaded for the payload
+static const u64 COMMAND_ASSET_TEXTURE_LOADED = 0x00040005;
 
 static const u64 COMMAND_STATE_UPDATE_VIEW_PORT = 0x00050001;
 static const u64 COMMAND_STATE_UPDATE_TOUCH_STATE = 0x00050002;
+static const u64 COMMAND_STATE_REQUEST_FRAME_STATS = 0x00050003;
+// NOTE: Reply to COMMAND_STATE_REQUEST_FRAME_STATS, see shell_send_frame_stats for the payload
+static const u64 COMMAND_STATE_FRAME_STATS = 0x00050004;
+
+inline const char* vm_command_name(u64 command_id) {
+    switch (command_id) {
+        case COMMAND_EXECUTE_MACRO: return "EXECUTE_MACRO";
+        case COMMAND_BEGIN_MACRO: return "BEGIN_MACRO";
+        case COMMAND_END_MACRO: return "END_MACRO";
+        case COMMAND_UPDATE_VIEWPORT: return "UPDATE_VIEWPORT";
+        case COMMAND_ADD_TEXT_BOUNDARIES: return "ADD_TEXT_BOUNDARIES";
+        case COMMAND_TOUCH_START: return "TOUCH_START";
+        case COMMAND_TOUCH_END: return "TOUCH_END";
+        case COMMAND_TOUCH_MOVE: return "TOUCH_MOVE";
+        case COMMAND_TOUCH_STATE: return "TOUCH_STATE";
+        case COMMAND_GAPI_DRAW_LINES: return "GAPI_DRAW_LINES";
+        case COMMAND_GAPI_DRAW_PATH: return "GAPI_DRAW_PATH";
+        case COMMAND_GAPI_DRAW_QUADS: return "GAPI_DRAW_QUADS";
+        case COMMAND_GAPI_DRAW_CENTERED_QUADS: return "GAPI_DRAW_CENTERED_QUADS";
+        case COMMAND_GAPI_DRAW_TEXTS: return "GAPI_DRAW_TEXTS";
+        case COMMAND_GAPI_SET_COLOR_PIPELINE: return "GAPI_SET_COLOR_PIPELINE";
+        case COMMAND_GAPI_SET_TEXTURE_PIPELINE: return "GAPI_SET_TEXTURE_PIPELINE";
+        case COMMAND_GAPI_SET_VIEWPORT: return "GAPI_SET_VIEWPORT";
+        case COMMAND_TRANSFORM_TRANSLATE: return "TRANSFORM_TRANSLATE";
+        case COMMAND_TRANSFORM_ROTATE: return "TRANSFORM_ROTATE";
+        case COMMAND_TRANSFORM_SCALE: return "TRANSFORM_SCALE";
+        case COMMAND_ASSET_LOAD_TEXTURE: return "ASSET_LOAD_TEXTURE";
+        case COMMAND_ASSET_LOAD_MACRO: return "ASSET_LOAD_MACRO";
+        case COMMAND_ASSET_REMOVE_TEXTURE: return "ASSET_REMOVE_TEXTURE";
+        case COMMAND_ASSET_REMOVE_MACRO: return "ASSET_REMOVE_MACRO";
+        case COMMAND_ASSET_TEXTURE_LOADED: return "ASSET_TEXTURE_LOADED";
+        case COMMAND_STATE_UPDATE_VIEW_PORT: return "STATE_UPDATE_VIEW_PORT";
+        case COMMAND_STATE_UPDATE_TOUCH_STATE: return "STATE_UPDATE_TOUCH_STATE";
+        case COMMAND_STATE_REQUEST_FRAME_STATS: return "STATE_REQUEST_FRAME_STATS";
+        case COMMAND_STATE_FRAME_STATS: return "STATE_FRAME_STATS";
+        default: return "UNKNOWN";
+    }
+}
 
 static const u64 COMMAND_MOUSE_BUTTON_UNKNOWN = 0;
 static const u64 COMMAND_MOUSE_BUTTON_LEFT = 1;